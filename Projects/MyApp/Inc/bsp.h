@@ -49,6 +49,7 @@ enum KernelAwareISRs {
     DMA1_STREAM6_PRIO       = QF_AWARE_ISR_CMSIS_PRI + 1,   // USART2 TX DMA
     DMA1_STREAM5_PRIO       = QF_AWARE_ISR_CMSIS_PRI + 1,   // USART2 RX DMA
     USART2_IRQ_PRIO         = QF_AWARE_ISR_CMSIS_PRI + 1,   // USART2 IRQ
+    TIM5_PRIO               = QF_AWARE_ISR_CMSIS_PRI + 1,   // HrTimer
     EXTI15_10_PRIO          = QF_AWARE_ISR_CMSIS_PRI + 10,
     // ...
     MAX_KERNEL_AWARE_CMSIS_PRI // keep always last
@@ -56,8 +57,30 @@ enum KernelAwareISRs {
 // "kernel-aware" interrupts should not overlap the PendSV priority
 Q_ASSERT_COMPILE(MAX_KERNEL_AWARE_CMSIS_PRI <= (0xFF >>(8-__NVIC_PRIO_BITS)));
 
+// Process time events in a QTicker AO at PRIO_TICKER (see hsm_id.h) rather
+// than in SysTick_Handler(). The ISR then only posts to the ticker, so its
+// duration no longer depends on the number of time events expiring on a tick
+// and lower priority ISRs are not held up by it. In exchange time events are
+// posted after the ticker is activated, i.e. after any RTC step of higher
+// priority in progress. Compare the SysTick line of IsrStatReport() (debug
+// build) with and without this option to see the ISR latency saved;
+// Bench::TickCost() gives the cost of QF::tickX_() that moves to thread level.
+// With only a few time events armed, as in this app, the post can cost more
+// than the QF::tickX_() call it replaces. It did on the host, so check on the
+// board before relying on it.
+#define ENABLE_BSP_TICKER
+
 void BspInit();
+#ifdef ENABLE_BSP_TICKER
+void BspTickerStart(uint8_t prio);
+void BspTickerPost();
+#endif
 void BspWrite(char const *buf, uint32_t len);
 uint32_t GetSystemMs();
 
+// DWT cycle counter. It runs at the core clock and wraps around in about 51s
+// at 84MHz, so it is only suitable for measuring short intervals.
+uint32_t GetCycleCnt();
+uint32_t GetCyclePerUs();
+
 #endif // BSP_H
@@ -34,6 +34,9 @@
 #include "fw_error.h"
 #include "fw_evt.h"
 #include "fw_pipe.h"
+#include "fw_batch.h"
+#include "fw_qstats.h"
+#include "fw_cpuload.h"
 
 using namespace FW;
 
@@ -44,8 +47,16 @@ enum {
     SYSTEM_START_CFM,
     SYSTEM_STOP_REQ,
     SYSTEM_STOP_CFM,
-    SYSTEM_STATE_TIMER,
+    SYSTEM_QUEUE_STATS_IND, // of type SystemQueueStatsInd
+    SYSTEM_CPU_LOAD_IND,    // of type SystemCpuLoadInd
+    SYSTEM_TRANS_TIMER,
     SYSTEM_TEST_TIMER,
+    SYSTEM_STATS_TIMER,
+    SYSTEM_TRACE_TIMER,
+    SYSTEM_REPORT_TIMER,
+    SYSTEM_LEAK_TIMER,
+    SYSTEM_BENCH,   // Static event used by Bench only.
+    SYSTEM_RTC_OVERRUN, // Static event posted by RtcBudget only.
     SYSTEM_DONE,
     SYSTEM_FAIL,
     
@@ -54,7 +65,7 @@ enum {
     UART_ACT_STOP_REQ,
     UART_ACT_STOP_CFM,
     UART_ACT_FAIL_IND,
-    UART_ACT_STATE_TIMER,
+    UART_ACT_TRANS_TIMER,
     UART_ACT_START,
     UART_ACT_DONE,
     UART_ACT_FAIL,
@@ -77,9 +88,10 @@ enum {
     UART_IN_START_CFM,
     UART_IN_STOP_REQ,
     UART_IN_STOP_CFM,
-    UART_IN_CHAR_IND,   // For testing only (by-passing fifo)
+    UART_IN_DATA_IND,   // Batch of received chars (by-passing fifo)
     UART_IN_FAIL_IND,
     UART_IN_STATE_TIMER,
+    UART_IN_BATCH_TIMER,
     UART_IN_DONE,
     UART_IN_DATA_RDY,   // of type Evt
     
@@ -91,6 +103,7 @@ enum {
     USER_BTN_DOWN_IND,  // of type Evt
     USER_BTN_STATE_TIMER,
     USER_BTN_TRIG,
+    USER_BTN_DEBOUNCE,
     USER_BTN_UP,
     USER_BTN_DOWN,
     
@@ -140,6 +153,33 @@ public:
         ErrorEvt(SYSTEM_STOP_CFM, seq, error, reason) {}
 };
 
+// Snapshot of all registered event queues (see fw_qstats.h). The sender calls
+// Snapshot() before posting it.
+class SystemQueueStatsInd : public Evt {
+public:
+    SystemQueueStatsInd(uint16_t seq) :
+        Evt(SYSTEM_QUEUE_STATS_IND, seq), m_count(0) {}
+    void Snapshot() { m_count = static_cast<uint8_t>(QueueStats::Snapshot(m_entry, QueueStats::MAX_QUEUE)); }
+    uint8_t GetCount() const { return m_count; }
+    QueueStats::Entry const &GetEntry(uint8_t i) const { return m_entry[i]; }
+private:
+    uint8_t m_count;
+    QueueStats::Entry m_entry[QueueStats::MAX_QUEUE];
+};
+
+// CPU load per priority level since the last indication (see fw_cpuload.h).
+class SystemCpuLoadInd : public Evt {
+public:
+    SystemCpuLoadInd(uint16_t seq) :
+        Evt(SYSTEM_CPU_LOAD_IND, seq),
+        m_count(static_cast<uint8_t>(CpuLoad::Snapshot(m_entry, CpuLoad::MAX_ENTRY))) {}
+    uint8_t GetCount() const { return m_count; }
+    CpuLoad::Entry const &GetEntry(uint8_t i) const { return m_entry[i]; }
+private:
+    uint8_t m_count;
+    CpuLoad::Entry m_entry[CpuLoad::MAX_ENTRY];
+};
+
 class SystemFail : public ErrorEvt {
 public:
     SystemFail(Error error, Reason reason) :
@@ -265,13 +305,10 @@ public:
         ErrorEvt(UART_IN_STOP_CFM, seq, error, reason) {}
 };
 
-class UartInCharInd : public Evt {
+class UartInDataInd : public BatchEvt<char, 32> {
 public:
-    UartInCharInd(uint16_t seq, char ch) :
-        Evt(UART_IN_CHAR_IND, seq), m_ch(ch) {}
-    char GetChar() const { return m_ch; }
-private:
-    char m_ch;
+    UartInDataInd(uint16_t seq) :
+        BatchEvt<char, 32>(UART_IN_DATA_IND, seq) {}
 };
 
 class UartInFailInd : public ErrorEvt {
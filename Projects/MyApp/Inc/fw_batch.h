@@ -0,0 +1,175 @@
+/*******************************************************************************
+ * Copyright (C) 2017 Gallium Studio LLC (Lawrence Lo). All rights reserved. 
+ * All rights reserved.
+ *
+ * This program is open source software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ******************************************************************************/
+
+#ifndef FW_BATCH_H
+#define FW_BATCH_H
+
+#include "qpcpp.h"
+#include "bsp.h"
+#include "fw_macro.h"
+#include "fw_evt.h"
+
+#define FW_BATCH_ASSERT(t_) ((t_) ? (void)0 : Q_onAssert("fw_batch.h", (int_t)__LINE__))
+
+namespace FW {
+
+// Event carrying up to N records of type T. It amortizes the cost of event
+// allocation and publishing over multiple records. T must be copy-assignable.
+// The size of the derived event must fit in one of the event pools.
+template <class T, uint8_t N>
+class BatchEvt : public Evt {
+public:
+    enum {
+        CAPACITY = N
+    };
+
+    class Iterator {
+    public:
+        Iterator(BatchEvt const &evt) : m_evt(evt), m_index(0) {}
+        bool HasNext() const { return m_index < m_evt.m_count; }
+        T const &Next() {
+            FW_BATCH_ASSERT(HasNext());
+            return m_evt.m_rec[m_index++];
+        }
+    protected:
+        BatchEvt const &m_evt;
+        uint8_t m_index;
+    };
+
+    BatchEvt(QP::QSignal signal, uint16_t seq = 0) :
+        Evt(signal, seq), m_count(0) {}
+
+    void Add(T const &rec) {
+        FW_BATCH_ASSERT(m_count < N);
+        m_rec[m_count++] = rec;
+    }
+    uint8_t GetCount() const { return m_count; }
+    bool IsFull() const { return m_count >= N; }
+    T const &Get(uint8_t index) const {
+        FW_BATCH_ASSERT(index < m_count);
+        return m_rec[index];
+    }
+
+protected:
+    uint8_t m_count;
+    T m_rec[N];
+};
+
+// Collects records into batch events of type E (derived from BatchEvt and
+// constructible as E(seq)) with an adaptive flush policy:
+// - A batch is flushed when it reaches the current threshold. The threshold
+//   starts at 1 so that at low rates each record is delivered immediately.
+// - A flush on threshold within windowMs of the previous flush doubles it (up
+//   to E::CAPACITY), so a sustained burst quickly ramps up to full batches
+//   while records arriving slower than that never wait for a batch to fill.
+// - The timer bounds the latency of a partial batch to windowMs. A flush on
+//   timeout halves the threshold as the rate has dropped.
+// Batches take their sequence numbers from nextSeq, the counter of the owner.
+// The owner forwards the timer signal to OnTimeout() and publishes the
+// returned event (if not NULL). Not thread-safe. It must only be used within
+// the owner HSM.
+template <class E, class T>
+class Batcher {
+public:
+    Batcher(QP::QTimeEvt &timer, uint32_t windowMs, uint16_t &nextSeq) :
+        m_timer(timer), m_windowMs(windowMs), m_nextSeq(nextSeq), m_evt(NULL), m_threshold(1),
+        m_flushMs(0) {
+        FW_BATCH_ASSERT(windowMs > 0);
+    }
+
+    // Discard any pending records and restore the initial threshold.
+    void Reset() {
+        m_timer.disarm();
+        if (m_evt) {
+            // Never published, so it is recycled immediately.
+            QP::QF::gc(m_evt);
+            m_evt = NULL;
+        }
+        m_threshold = 1;
+        m_flushMs = GetSystemMs() - m_windowMs;
+    }
+    // Returns a batch ready to be published, or NULL if records are still being collected.
+    E *Add(T const &rec) {
+        if (m_evt == NULL) {
+            m_evt = new E(m_nextSeq++);
+        }
+        m_evt->Add(rec);
+        if (m_evt->GetCount() >= m_threshold) {
+            uint32_t now = GetSystemMs();
+            if ((now - m_flushMs) < m_windowMs) {
+                m_threshold = LESS(m_threshold * 2, static_cast<uint32_t>(E::CAPACITY));
+            }
+            m_flushMs = now;
+            return Take();
+        }
+        if (m_evt->GetCount() == 1) {
+            m_timer.armX(ROUND_UP_DIV(m_windowMs, BSP_MSEC_PER_TICK));
+        }
+        return NULL;
+    }
+    // Called upon the timer signal. Returns the partial batch, or NULL if the
+    // timeout is stale, i.e. it was already queued when a flush on threshold
+    // disarmed the timer. The timer may have been armed again for a newer batch.
+    E *OnTimeout() {
+        if ((m_evt == NULL) || (m_timer.ctr() != 0)) {
+            return NULL;
+        }
+        m_threshold = GREATER(m_threshold / 2, 1UL);
+        m_flushMs = GetSystemMs();
+        return Take();
+    }
+    // Called when the owner stops. Returns the partial batch, or NULL if empty.
+    E *Flush() {
+        return m_evt ? Take() : NULL;
+    }
+    uint32_t GetThreshold() const { return m_threshold; }
+
+protected:
+    E *Take() {
+        E *evt = m_evt;
+        m_evt = NULL;
+        m_timer.disarm();
+        return evt;
+    }
+
+    QP::QTimeEvt &m_timer;
+    uint32_t m_windowMs;
+    uint16_t &m_nextSeq;
+    E *m_evt;
+    uint32_t m_threshold;
+    uint32_t m_flushMs;     // System time of the last flush.
+
+    // Unimplemented to disallow built-in memberwise copy constructor and assignment operator.
+    Batcher(Batcher const &);
+    Batcher& operator= (Batcher const &);
+};
+
+} // namespace FW
+
+#endif // FW_BATCH_H
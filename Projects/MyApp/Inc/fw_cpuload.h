@@ -0,0 +1,90 @@
+/*******************************************************************************
+ * Copyright (C) 2017 Gallium Studio LLC (Lawrence Lo). All rights reserved. 
+ * All rights reserved.
+ *
+ * This program is open source software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ******************************************************************************/
+
+#ifndef FW_CPULOAD_H
+#define FW_CPULOAD_H
+
+#include "qpcpp.h"
+
+namespace FW {
+
+// CPU cycles spent at each priority level (AOs and extended threads), in
+// kernel-aware ISRs and in the idle thread, counted with the DWT cycle counter.
+// Cycles are charged by the QXK callbacks enabled by QXK_CPU_LOAD in
+// qf_port.h. The peak RTC step of an AO only counts the cycles spent by the AO
+// itself, not those of higher priority AOs or ISRs preempting it.
+// Cycles in an ISR before QXK_ISR_ENTRY() are charged to the preempted thread.
+class CpuLoad {
+public:
+    enum {
+        PRIO_ISR = 0xFF,    // Pseudo priority of all kernel-aware ISRs.
+        MAX_ENTRY = 16
+    };
+    // Load of one priority level over a report interval, as carried by the
+    // load event.
+    class Entry {
+    public:
+        uint8_t m_prio;         // 0 for idle, PRIO_ISR for ISRs.
+        uint16_t m_permille;    // Share of the interval in 1/1000.
+        uint32_t m_maxRtcUs;    // Longest RTC step (AOs only).
+    };
+    // Copy the load of up to count priority levels that have run since the
+    // last call into entry[], and start a new interval. Idle gets the share not
+    // used by others, which includes the time the CPU sleeps (the cycle counter
+    // stops in sleep mode). Returns the number of entries copied.
+    static uint32_t Snapshot(Entry *entry, uint32_t count);
+
+    // Called by the QXK callbacks. OnRtcEnd() returns the cycles of the step.
+    static void OnContextSw(uint8_t prio);
+    static void OnIsrEntry();
+    static void OnIsrExit();
+    static void OnRtcBegin(uint8_t prio);
+    static uint32_t OnRtcEnd(uint8_t prio);
+
+private:
+    enum {
+        SLOT_ISR = QF_MAX_ACTIVE + 1,
+        SLOT_COUNT
+    };
+    static void Charge();
+
+    // Cycles per slot in the current interval. 64-bit since a 60s interval
+    // exceeds 2^32 cycles at 84MHz.
+    static uint64_t m_cycles[SLOT_COUNT];
+    static uint32_t m_maxRtc[SLOT_COUNT];
+    static uint32_t m_rtcBegin[SLOT_COUNT];
+    static uint32_t m_stamp;        // Cycle count when last charged.
+    static uint32_t m_beginMs;      // Start of the current interval.
+    static uint8_t m_curr;          // Priority of the running thread.
+    static uint8_t m_isrNest;
+};
+
+} // namespace FW
+
+#endif // FW_CPULOAD_H
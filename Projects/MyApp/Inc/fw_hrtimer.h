@@ -0,0 +1,104 @@
+/*******************************************************************************
+ * Copyright (C) 2017 Gallium Studio LLC (Lawrence Lo). All rights reserved. 
+ * All rights reserved.
+ *
+ * This program is open source software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ******************************************************************************/
+
+#ifndef FW_HRTIMER_H
+#define FW_HRTIMER_H
+
+#include "qpcpp.h"
+
+#define FW_HRTIMER_ASSERT(t_) ((t_) ? (void)0 : Q_onAssert("fw_hrtimer.h", (int_t)__LINE__))
+
+namespace FW {
+
+// One-shot timer with microsecond resolution, for timeouts below the system
+// tick (e.g. debouncing, inter-byte gaps). Like QTimeEvt, it is a static event
+// posted to its owner AO upon expiry. It must have static storage (e.g. be a
+// member of a static AO), since QEvt leaves poolId_ uninitialized and only
+// zero-initialization marks it as not from any event pool.
+// Armed timers are kept in a queue sorted by deadline. Only the head is loaded
+// into a compare channel of a free-running 32-bit timer (TIM5 at 1MHz), so the
+// hardware interrupts once per expiry rather than periodically.
+// When FW_HRTIMER_HOST is defined (host builds), the hardware is replaced by a
+// virtual clock advanced by HostAdvance().
+class HrTimer : public QP::QEvt {
+public:
+    enum {
+        // Deadlines are compared with wrap-around arithmetic, so they must be
+        // within half the range of the clock.
+        MAX_US = 0x7FFFFFFF
+    };
+
+    HrTimer(QP::QActive *owner, QP::QSignal sig) :
+        QP::QEvt(sig), m_next(NULL), m_owner(owner), m_deadline(0), m_armed(false) {
+        FW_HRTIMER_ASSERT(owner);
+    }
+
+    // Arm the timer to expire in us microseconds. It must not be armed.
+    void Start(uint32_t us);
+    // Returns true if the timer was armed. If false, it has already expired
+    // and the event may still be in the owner's queue.
+    bool Stop();
+    bool IsArmed() const { return m_armed; }
+
+    // Start the clock. Must be called once before any timer is started.
+    static void Init();
+    // Free-running microsecond clock. Wraps around in about 71 minutes.
+    static uint32_t GetTimeUs();
+    // Must be called from the compare interrupt of the clock (TIM5_IRQHandler).
+    static void IsrHandler();
+#ifdef FW_HRTIMER_HOST
+    // Advance the virtual clock by us, expiring timers in deadline order.
+    static void HostAdvance(uint32_t us);
+#endif
+
+protected:
+    static bool IsDue(uint32_t deadline, uint32_t now) {
+        return static_cast<int32_t>(deadline - now) <= 0;
+    }
+    static void ExpireDue(uint32_t now);
+    static void SetCompare();
+
+    HrTimer *m_next;
+    QP::QActive *m_owner;
+    uint32_t m_deadline;        // In us, as returned by GetTimeUs().
+    bool volatile m_armed;
+
+    static HrTimer *m_head;     // Armed timers sorted by deadline.
+#ifdef FW_HRTIMER_HOST
+    static uint32_t m_hostTimeUs;
+#endif
+
+    // Unimplemented to disallow built-in memberwise copy constructor and assignment operator.
+    HrTimer(HrTimer const &);
+    HrTimer& operator= (HrTimer const &);
+};
+
+} // namespace FW
+
+#endif // FW_HRTIMER_H
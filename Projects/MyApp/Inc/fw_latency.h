@@ -0,0 +1,83 @@
+/*******************************************************************************
+ * Copyright (C) 2017 Gallium Studio LLC (Lawrence Lo). All rights reserved. 
+ * All rights reserved.
+ *
+ * This program is open source software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ******************************************************************************/
+
+#ifndef FW_LATENCY_H
+#define FW_LATENCY_H
+
+#include "qpcpp.h"
+
+namespace FW {
+
+// Debug-build histograms of post-to-dispatch latency per (signal, AO).
+// Events are stamped by QActive::post_()/postLIFO()/postCtrl() and measured by the
+// QF::onEvtDispatch() callback, which are only enabled when QF_EVT_LATENCY is
+// defined in qf_port.h. For a published event with multiple subscribers, the
+// stamp is the time of the last post (they are all posted with the scheduler
+// locked). Static events (other than the tick event of QTicker) are not
+// stamped, since they may be in read-only memory, and are not measured.
+// Long latencies of a signal to a low priority AO usually indicate that it is
+// starved by higher priority AOs (see hsm_id.h).
+class EvtLatency {
+public:
+    enum {
+        // Bucket n counts latencies in [2^(n-1), 2^n) cycles. The last
+        // bucket saturates.
+        BUCKET_COUNT = 20,
+        // Maximum number of distinct (signal, AO) pairs is SLOT_COUNT.
+        SLOT_ORDER = 6,
+        SLOT_COUNT = 1 << SLOT_ORDER
+    };
+    static void OnDispatch(uint8_t prio, QP::QSignal sig, uint32_t cycles);
+    // Copy the histogram of (sig, prio) into hist[BUCKET_COUNT].
+    // Returns the total number of samples, or 0 if none.
+    static uint32_t GetHist(QP::QSignal sig, uint8_t prio, uint16_t *hist);
+    // Print the histograms of all (signal, AO) pairs with samples.
+    static void Report();
+    // Clear all histograms.
+    static void Reset();
+    static uint32_t GetOverflowCount() { return m_overflowCount; }
+
+private:
+    class Slot {
+    public:
+        uint16_t m_key;     // 0 if free.
+        uint16_t m_hist[BUCKET_COUNT];
+    };
+    static uint16_t GetKey(QP::QSignal sig, uint8_t prio) {
+        return static_cast<uint16_t>((sig << 6) | (prio & 0x3F));
+    }
+    static Slot *Find(uint16_t key, bool alloc);
+
+    static Slot m_slot[SLOT_COUNT];
+    static uint32_t m_overflowCount;
+};
+
+} // namespace FW
+
+#endif // FW_LATENCY_H
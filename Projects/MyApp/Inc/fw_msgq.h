@@ -0,0 +1,71 @@
+/*******************************************************************************
+ * Copyright (C) 2017 Gallium Studio LLC (Lawrence Lo). All rights reserved. 
+ * All rights reserved.
+ *
+ * This program is open source software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ******************************************************************************/
+
+#ifndef FW_MSGQ_H
+#define FW_MSGQ_H
+
+#include "qpcpp.h"
+#include "bsp.h"
+#include "fw_macro.h"
+
+namespace FW {
+
+// Bounded queue of up to N messages of type T, for handing off fixed-size
+// requests (e.g. from AOs to a blocking driver thread) over QP::QXMsgQueue.
+// T is copied byte-wise with interrupts disabled, so it must be trivially
+// copyable and small. Only extended threads block. Put() from an ISR or an AO
+// returns false right away when the queue is full.
+template <class T, uint16_t N>
+class MsgQueue {
+public:
+    enum {
+        WAIT_FOREVER = 0
+    };
+    MsgQueue() { m_queue.init(m_stor, sizeof(T), N); }
+
+    bool Put(T const &msg, uint32_t timeoutMs = WAIT_FOREVER) {
+        return m_queue.put(&msg, ToTicks(timeoutMs), 0);
+    }
+    bool Get(T &msg, uint32_t timeoutMs = WAIT_FOREVER) {
+        return m_queue.get(&msg, ToTicks(timeoutMs), 0);
+    }
+    uint16_t GetMinFree() const { return static_cast<uint16_t>(m_queue.getNMin()); }
+
+private:
+    static uint_fast16_t ToTicks(uint32_t timeoutMs) {
+        return static_cast<uint_fast16_t>(ROUND_UP_DIV(timeoutMs, BSP_MSEC_PER_TICK));
+    }
+
+    QP::QXMsgQueue m_queue;
+    T m_stor[N];
+};
+
+} // namespace FW
+
+#endif // FW_MSGQ_H
@@ -84,7 +84,11 @@ public:
         return (m_readIndex - m_writeIndex - 1) & m_mask;
     }
     uint32_t GetDiff(uint32_t a, uint32_t b) { return (a - b) & m_mask; }
-    uint32_t GetAddr(uint32_t index) { return reinterpret_cast<uint32_t>(&m_stor[index & m_mask]); }
+    // Addresses fit in 32 bits on the target, and in host builds linked at a
+    // low address (see posix/Makefile).
+    uint32_t GetAddr(uint32_t index) {
+        return static_cast<uint32_t>(reinterpret_cast<uintptr_t>(&m_stor[index & m_mask]));
+    }
     uint32_t GetWriteAddr() { return GetAddr(m_writeIndex); }
     uint32_t GetReadAddr() { return GetAddr(m_readIndex); }
     uint32_t GetMaxAddr() { return GetAddr(m_mask); }
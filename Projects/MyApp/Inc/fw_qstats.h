@@ -0,0 +1,93 @@
+/*******************************************************************************
+ * Copyright (C) 2017 Gallium Studio LLC (Lawrence Lo). All rights reserved. 
+ * All rights reserved.
+ *
+ * This program is open source software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ******************************************************************************/
+
+#ifndef FW_QSTATS_H
+#define FW_QSTATS_H
+
+#include "qpcpp.h"
+
+namespace FW {
+
+// Registry of the event queues of all started AOs (event, control and defer
+// queues). It reports the low-watermark (minimum free entries), total posts
+// and rejected posts of each queue, which are maintained by QP when
+// QF_EQUEUE_STATS is defined in qf_port.h. It is meant for right-sizing
+// EVT_QUEUE_COUNT, DEFER_QUEUE_COUNT, etc under real traffic.
+class QueueStats {
+public:
+    enum {
+        MAX_QUEUE = 12
+    };
+    enum Type {
+        TYPE_EVT,
+        TYPE_CTRL,
+        TYPE_DEFER
+    };
+    // Snapshot of one queue, as carried by the stats event.
+    class Entry {
+    public:
+        uint8_t m_index;        // Registry index, see GetOwner().
+        uint8_t m_prio;         // Priority of owning AO.
+        uint8_t m_type;         // Type.
+        uint16_t m_capacity;    // Total entries (including front event).
+        uint16_t m_minFree;     // Minimum free entries ever.
+        uint16_t m_rejectCount; // Rejected posts (saturates).
+        uint32_t m_postCount;   // Total posts (wraps).
+    };
+    // Register the event queue and, if set up, the control queue of an AO.
+    // Must be called after the AO has been started.
+    static void Register(QP::QActive const *act, char const *owner);
+    // Register a queue (e.g. a defer queue) owned by the AO at prio. Registering
+    // the same queue again has no effect.
+    static void Register(QP::QEQueue const *queue, char const *owner, uint8_t prio, Type type);
+    // Copy up to count entries into entry[]. Returns the number of entries copied.
+    static uint32_t Snapshot(Entry *entry, uint32_t count);
+    // Print all registered queues.
+    static void Report();
+    static char const *GetTypeName(uint8_t type);
+    // Name of the AO or region owning the queue at index.
+    static char const *GetOwner(uint8_t index);
+
+private:
+    class Reg {
+    public:
+        QP::QEQueue const *m_queue;
+        char const *m_owner;
+        uint8_t m_prio;
+        uint8_t m_type;
+    };
+    static void Fill(uint32_t index, Entry &entry);
+
+    static Reg m_reg[MAX_QUEUE];
+    static uint32_t m_count;
+};
+
+} // namespace FW
+
+#endif // FW_QSTATS_H
@@ -0,0 +1,90 @@
+/*******************************************************************************
+ * Copyright (C) 2017 Gallium Studio LLC (Lawrence Lo). All rights reserved. 
+ * All rights reserved.
+ *
+ * This program is open source software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ******************************************************************************/
+
+#ifndef FW_RTCBUDGET_H
+#define FW_RTCBUDGET_H
+
+#include "qpcpp.h"
+
+namespace FW {
+
+// Per-AO budget of an RTC step, checked at the end of every dispatch. A step
+// is measured by CpuLoad (fw_cpuload.h) as the cycles spent by the AO itself,
+// so preemption does not count against it. An overrun records the signal
+// and the (leaf) state handler the AO was in when the event was dispatched.
+// The check is a compare per RTC step, so it is meant to be always enabled.
+class RtcBudget {
+public:
+    enum {
+        MAX_ENTRY = 8
+    };
+    // Overruns of one AO since the last snapshot.
+    class Entry {
+    public:
+        QP::QStateHandler m_state;  // State of the last overrun.
+        QP::QSignal m_sig;          // Signal of the last overrun.
+        uint8_t m_prio;
+        uint16_t m_count;           // Number of overruns (saturates).
+        uint32_t m_maxUs;           // Longest overrun step.
+        uint32_t m_budgetUs;
+    };
+    // Set the budget of the AO at prio. 0 disables the check.
+    static void Set(uint8_t prio, uint32_t budgetUs);
+    // Post a static event of sig to act when an overrun is detected. No more
+    // is posted until Snapshot() is called.
+    static void SetReport(QP::QActive *act, QP::QSignal sig);
+    // Copy up to count AOs with overruns into entry[] and clear their
+    // records. Returns the number of entries copied.
+    static uint32_t Snapshot(Entry *entry, uint32_t count);
+
+    // Called by the QXK callbacks.
+    static void OnBegin(uint8_t prio, QP::QEvt const *e);
+    static void OnEnd(uint8_t prio, uint32_t cycles);
+
+private:
+    class Slot {
+    public:
+        uint32_t m_budget;          // In cycles. 0 if disabled.
+        uint32_t m_max;             // In cycles.
+        QP::QStateHandler m_state;  // Of the step in progress.
+        QP::QStateHandler m_overrunState;
+        QP::QSignal m_sig;          // Of the step in progress.
+        QP::QSignal m_overrunSig;
+        uint16_t m_count;
+    };
+
+    static Slot m_slot[QF_MAX_ACTIVE + 1];
+    static QP::QActive *m_reportAct;
+    static QP::QEvt m_reportEvt;
+    static bool m_reportPending;
+};
+
+} // namespace FW
+
+#endif // FW_RTCBUDGET_H
@@ -0,0 +1,75 @@
+/*******************************************************************************
+ * Copyright (C) 2017 Gallium Studio LLC (Lawrence Lo). All rights reserved. 
+ * All rights reserved.
+ *
+ * This program is open source software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ******************************************************************************/
+
+#ifndef FW_SCHEDTRACE_H
+#define FW_SCHEDTRACE_H
+
+#include "qpcpp.h"
+
+namespace FW {
+
+// Ring buffer of QXK context switches, each stamped with the DWT cycle counter
+// and tagged with its cause (QP::QXK::SwCause). Recording is a few stores with
+// interrupts already disabled by the kernel, so it is always on. The ring is
+// frozen while it is exported to the log UART in chunks (by System), and then
+// decoded on the host by Tools/sched_trace.py.
+class SchedTrace {
+public:
+    enum {
+        REC_COUNT = 128     // Must be a power of 2.
+    };
+    // Stop and resume recording. Switches while frozen are not recorded.
+    static void Freeze();
+    static void Unfreeze();
+    // Print up to count records starting from index (0 for the oldest),
+    // which should be done while frozen. Index 0 also prints a header.
+    // Returns the index to continue from, or 0 after the last record.
+    static uint32_t Export(uint32_t index, uint32_t count);
+
+    // Called by the QXK callback with interrupts disabled.
+    static void OnContextSw(uint8_t prio, uint8_t cause);
+
+private:
+    class Rec {
+    public:
+        uint32_t m_stamp;   // Cycle count.
+        uint8_t m_prev;     // Priority switched from.
+        uint8_t m_next;     // Priority switched to.
+        uint8_t m_cause;
+    };
+
+    static Rec m_rec[REC_COUNT];
+    static uint32_t m_head;     // Total number of records written.
+    static uint8_t m_prev;      // Priority of the running thread.
+    static bool m_frozen;
+};
+
+} // namespace FW
+
+#endif // FW_SCHEDTRACE_H
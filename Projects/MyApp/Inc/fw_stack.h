@@ -0,0 +1,78 @@
+/*******************************************************************************
+ * Copyright (C) 2017 Gallium Studio LLC (Lawrence Lo). All rights reserved. 
+ * All rights reserved.
+ *
+ * This program is open source software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ******************************************************************************/
+
+#ifndef FW_STACK_H
+#define FW_STACK_H
+
+#include "qpcpp.h"
+
+namespace FW {
+
+// High-watermark of the main stack (CSTACK in the .icf), which is shared by
+// main(), all AOs (QXK basic threads) and ISRs, and of the private stacks of
+// QXK extended threads. Unused stack is painted with a pattern, and the used
+// part is found by scanning for the first overwritten word. It is meant for
+// right-sizing __ICFEDIT_size_cstack__ and the extended thread stacks under
+// real traffic. When FW_STACK_HOST is defined (host builds), the main stack is
+// the one of the host process and is reported as 0/0.
+class StackStats {
+public:
+    enum {
+        MAX_THREAD = 4
+    };
+    // Paint the main stack below the current stack pointer. Must be called
+    // first thing in main(), before any deep call chain or interrupt.
+    static void PaintMain();
+    static uint32_t GetMainSize();
+    static uint32_t GetMainUsed();
+    // Register an extended thread, whose stack is painted by QXK when it is
+    // started. Must be called after the thread has been started.
+    static void Register(QP::QXThread const *thread, char const *name);
+    // Print the main stack and all registered threads.
+    static void Report();
+
+private:
+    enum {
+        // Words left unpainted below the stack pointer of PaintMain(), for
+        // its own frame.
+        PAINT_MARGIN = 16
+    };
+    class Reg {
+    public:
+        QP::QXThread const *m_thread;
+        char const *m_name;
+    };
+
+    static Reg m_reg[MAX_THREAD];
+    static uint32_t m_count;
+};
+
+} // namespace FW
+
+#endif // FW_STACK_H
@@ -0,0 +1,95 @@
+/*******************************************************************************
+ * Copyright (C) 2017 Gallium Studio LLC (Lawrence Lo). All rights reserved. 
+ * All rights reserved.
+ *
+ * This program is open source software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ******************************************************************************/
+
+#ifndef FW_TRACKER_H
+#define FW_TRACKER_H
+
+#include "qpcpp.h"
+
+namespace FW {
+
+// Debug-build tracker of dynamic event lifetime. It is fed by the QF::onEvtNew()
+// and QF::onEvtGc() callbacks, which are only enabled when QF_EVT_TRACKER is
+// defined in qf_port.h.
+// It records the allocation site and timestamp of every live event (the signal
+// is read from the live event itself), and keeps a log2 histogram of new-to-gc
+// latency (in CPU cycles) per signal.
+class EvtTracker {
+public:
+    // Allocation site of an event allocated from an ISR has this bit set with the
+    // lower bits holding the exception number. Otherwise it is the priority of
+    // the active object (0 for idle/startup). When FW_TRACKER_HOST is defined
+    // (host builds), the exception number is not available and reads as 0.
+    enum {
+        SITE_ISR = 0x80,
+        SITE_MASK = 0x7F
+    };
+    enum {
+        // SLOT_COUNT must be larger than the total number of blocks in all
+        // event pools.
+        SLOT_ORDER = 8,
+        SLOT_COUNT = 1 << SLOT_ORDER
+    };
+    static void OnNew(QP::QEvt const *e);
+    static void OnGc(QP::QEvt const *e);
+    // Print events that have been alive for at least thresholdMs.
+    // Return the number of such events.
+    static uint32_t ReportLeak(uint32_t thresholdMs);
+    // Print the new-to-gc latency histograms of all signals with samples.
+    static void ReportLatency();
+    static uint32_t GetLiveCount() { return m_liveCount; }
+    static uint32_t GetMaxLiveCount() { return m_maxLiveCount; }
+    static uint32_t GetOverflowCount() { return m_overflowCount; }
+
+private:
+    enum {
+        // Bucket n counts latencies in [2^(n-1), 2^n) cycles. The last
+        // bucket saturates.
+        BUCKET_COUNT = 24
+    };
+    class Slot {
+    public:
+        QP::QEvt const *m_evt;
+        uint32_t m_ms;
+        uint32_t m_cycle;
+        uint8_t m_site;
+    };
+    static uint32_t Hash(QP::QEvt const *e);
+    static uint8_t GetSite();
+
+    static Slot m_slot[SLOT_COUNT];
+    static uint16_t m_hist[][BUCKET_COUNT];
+    static uint32_t m_liveCount;
+    static uint32_t m_maxLiveCount;
+    static uint32_t m_overflowCount;
+};
+
+} // namespace FW
+
+#endif // FW_TRACKER_H
@@ -0,0 +1,93 @@
+/*******************************************************************************
+ * Copyright (C) 2017 Gallium Studio LLC (Lawrence Lo). All rights reserved. 
+ * All rights reserved.
+ *
+ * This program is open source software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ******************************************************************************/
+
+#ifndef FW_TRANS_H
+#define FW_TRANS_H
+
+#include "qpcpp.h"
+#include "fw_evt.h"
+
+namespace FW {
+
+// Table of outstanding request/confirm transactions of an HSM.
+// Each entry is keyed by the sequence number of the request and the signal of
+// the expected CFM, so a stale or unexpected CFM is never counted against the
+// wrong request. Entries are tagged with a group number so that several
+// independent groups of requests can be in flight at the same time.
+// All entries share a single one-shot timer, which is always armed to the
+// earliest deadline. The owner forwards the timer signal to HandleTimeout().
+// Not thread-safe. It must only be used within the owner HSM.
+class TransTable {
+public:
+    class Entry {
+    public:
+        uint32_t m_deadline;    // In ms, as returned by GetSystemMs().
+        uint16_t m_seq;
+        QP::QSignal m_cfmSig;   // 0 if entry is free.
+        uint8_t m_group;
+    };
+
+    // All entries of stor[] are cleared. The timer is not touched, as QF may
+    // not be initialized yet.
+    TransTable(Entry stor[], uint8_t count, QP::QTimeEvt &timer);
+
+    // Remove all entries and stop the timer.
+    void Reset();
+    // Register an outstanding request. Asserts if the table is full.
+    void Add(uint16_t seq, QP::QSignal cfmSig, uint8_t group, uint32_t timeoutMs);
+    // Match a received CFM against outstanding requests. If matched, the entry is
+    // removed and its group is returned via group (if not NULL).
+    // Returns false for a stale or unexpected CFM, which should be ignored.
+    bool Remove(ErrorEvt const &cfm, uint8_t *group = NULL);
+    // Remove all expired entries and re-arm the timer for the next deadline.
+    // Returns the number of expired entries. The group of the first expired entry
+    // is returned via group (if not NULL).
+    uint32_t HandleTimeout(uint8_t *group = NULL);
+    // Returns true if no request in the group is outstanding.
+    bool IsGroupDone(uint8_t group) const;
+    bool IsEmpty() const { return m_used == 0; }
+    uint8_t GetUsedCount() const { return m_used; }
+
+protected:
+    void ArmTimer();
+    void Free(Entry &entry);
+
+    Entry *m_stor;
+    uint8_t m_count;
+    uint8_t m_used;
+    QP::QTimeEvt &m_timer;
+
+    // Unimplemented to disallow built-in memberwise copy constructor and assignment operator.
+    TransTable(TransTable const &);
+    TransTable& operator= (TransTable const &);
+};
+
+} // namespace FW
+
+#endif // FW_TRANS_H
@@ -46,12 +46,15 @@ enum {
 // The maximum priority is defined in qf_port.h as QF_MAX_ACTIVE (32)
 enum
 {
+    PRIO_TICKER     = 31,   // See ENABLE_BSP_TICKER in bsp.h.
     PRIO_UART2_ACT  = 30,
     PRIO_CONSOLE    = 28,
     PRIO_SYSTEM     = 26,
     PRIO_USER_BTN   = 24,
     PRIO_USER_LED   = 22,
-    PRIO_SAMPLE     = 5
+    PRIO_MUTEX_TEST = 6,    // Uses 6 to 8. See MutexTest.h.
+    PRIO_SAMPLE     = 5,
+    PRIO_MSGQ_TEST  = 3     // Uses 3 to 4. See MsgQueueTest.h.
 };
 
 } // namespace APP
@@ -0,0 +1,93 @@
+/*******************************************************************************
+ * Copyright (C) 2017 Gallium Studio LLC (Lawrence Lo). All rights reserved. 
+ * All rights reserved.
+ *
+ * This program is open source software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ******************************************************************************/
+
+#ifndef ISR_ROUTE_H
+#define ISR_ROUTE_H
+
+#include "qpcpp.h"
+#include "hsm_id.h"
+#include "event.h"
+
+// Define to publish ISR signals as before, e.g. to compare ISR latency
+// (see IsrStatReport()). Owners then subscribe to them again.
+//#define ISR_ROUTE_PUBLISH
+
+#define ISR_ROUTE_ASSERT(t_) ((t_) ? (void)0 : Q_onAssert("isr_route.h", (int_t)__LINE__))
+
+namespace APP {
+
+// Routing table of driver-internal signals raised from ISRs.
+// Each of them is only handled by the AO owning the driver, so it is posted
+// directly to the owner rather than published. This avoids locking the scheduler
+// and walking the subscriber set in interrupt context. When sig is a constant
+// the switch is resolved at compile time.
+// The table is maintained by hand. A signal listed here is not published, so
+// any subscriber other than the owner would never receive it (see
+// IsrRouteCheck()). The owner only subscribes to it when ISR_ROUTE_PUBLISH is
+// defined, which publishes instead.
+inline uint8_t GetIsrRoutePrio(QP::QSignal sig) {
+    switch (sig) {
+        case UART_OUT_DMA_DONE:
+        case UART_IN_DATA_RDY:  return PRIO_UART2_ACT;
+        case USER_BTN_TRIG:     return PRIO_USER_BTN;
+        default:                return 0;
+    }
+}
+
+// Asserts that no AO subscribes to a signal listed in GetIsrRoutePrio(), as it
+// would never receive it. Call once all AOs have been started, since they
+// subscribe in their initial transitions. Debug build only.
+inline void IsrRouteCheck() {
+#if !(defined ISR_ROUTE_PUBLISH) && !(defined NDEBUG)
+    for (enum_t sig = QP::Q_USER_SIG; sig < MAX_PUB_SIG; sig++) {
+        if (GetIsrRoutePrio(static_cast<QP::QSignal>(sig)) != 0) {
+            ISR_ROUTE_ASSERT(!QP::QF::hasSubscriber(sig));
+        }
+    }
+#endif
+}
+
+// Must only be called from ISRs for signals listed in GetIsrRoutePrio().
+// The owners set up an ISR inbox, so the post does not disable interrupts
+// when QF_ISR_POST_LOCKFREE is defined in qf_port.h.
+inline void IsrRoutePost(QP::QEvt const *e) {
+#ifdef ISR_ROUTE_PUBLISH
+    QP::QF::PUBLISH(e, 0);
+#else
+    uint8_t prio = GetIsrRoutePrio(e->sig);
+    ISR_ROUTE_ASSERT(prio != 0);
+    QP::QActive *act = QP::QF::active_[prio];
+    ISR_ROUTE_ASSERT(act);
+    act->POST(e, 0);
+#endif
+}
+
+} // namespace APP
+
+#endif // ISR_ROUTE_H
@@ -54,6 +54,10 @@ void SysTick_Handler(void);
 void DMA1_Stream6_IRQHandler(void);
 void USART2_IRQHandler(void);
 void EXTI15_10_IRQHandler(void);
+void TIM5_IRQHandler(void);
+
+// Print and clear ISR cycle statistics.
+void IsrStatReport(void);
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,167 @@
+/*******************************************************************************
+ * Copyright (C) 2017 Gallium Studio LLC (Lawrence Lo). All rights reserved. 
+ * All rights reserved.
+ *
+ * This program is open source software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ******************************************************************************/
+
+#include <new>
+#include "qpcpp.h"
+#include "bsp.h"
+#include "fw_macro.h"
+#include "fw_log.h"
+#include "hsm_id.h"
+#include "event.h"
+#include "Bench.h"
+
+Q_DEFINE_THIS_FILE
+
+using namespace FW;
+
+namespace APP {
+
+// Static event. Being zero-initialized before construction, its poolId_ is 0
+// so publishing it does not involve the event pools. Static events are not
+// stamped with QF_EVT_LATENCY, so it can be const.
+static QEvt const benchEvt(SYSTEM_BENCH);
+
+// Publish with the scheduler locked so that subscribers (including those of
+// higher priority than the caller) only run after the measurement.
+// Returns the average number of cycles per publish.
+uint32_t Bench::MeasurePublish(QActive const *sender) {
+    (void)sender;   // Unused when Q_SPY is not defined.
+    QXMutex lock;
+    lock.init(QF_MAX_ACTIVE);
+    lock.lock();
+    uint32_t start = GetCycleCnt();
+    for (uint32_t i = 0; i < PUBLISH_ITER_COUNT; i++) {
+        QF::PUBLISH(&benchEvt, sender);
+    }
+    uint32_t cycles = GetCycleCnt() - start;
+    lock.unlock();
+    return cycles / PUBLISH_ITER_COUNT;
+}
+
+void Bench::PublishCost(QActive const *sender) {
+    // The single subscriber has the highest priority, so its queue is drained
+    // right after the scheduler is unlocked.
+    static uint8_t const subscriber[] = { PRIO_UART2_ACT, PRIO_USER_BTN, PRIO_USER_LED };
+    uint32_t cycles[3];
+    cycles[0] = MeasurePublish(sender);
+    QF::active_[subscriber[0]]->subscribe(SYSTEM_BENCH);
+    cycles[1] = MeasurePublish(sender);
+    for (uint32_t i = 1; i < ARRAY_COUNT(subscriber); i++) {
+        QF::active_[subscriber[i]]->subscribe(SYSTEM_BENCH);
+    }
+    cycles[2] = MeasurePublish(sender);
+    for (uint32_t i = 0; i < ARRAY_COUNT(subscriber); i++) {
+        QF::active_[subscriber[i]]->unsubscribe(SYSTEM_BENCH);
+    }
+    uint32_t cyclePerUs = GetCyclePerUs();
+    PRINT("Bench: publish sub=0 %lucyc(%luns)\n\r", cycles[0], cycles[0] * 1000 / cyclePerUs);
+    PRINT("Bench: publish sub=1 %lucyc(%luns)\n\r", cycles[1], cycles[1] * 1000 / cyclePerUs);
+    PRINT("Bench: publish sub=%lu %lucyc(%luns)\n\r", static_cast<uint32_t>(ARRAY_COUNT(subscriber)), cycles[2],
+          cycles[2] * 1000 / cyclePerUs);
+}
+
+// Post a burst of events to act with the scheduler locked. Unlocking it
+// activates act (which must be of higher priority than the caller) to
+// dispatch all of them. Returns the average number of cycles per event.
+uint32_t Bench::MeasureActivation(QActive *act, uint8_t burst, QActive const *sender) {
+    (void)sender;   // Unused when Q_SPY is not defined.
+    uint_fast8_t savedBurst = act->getBurst();
+    act->setBurst(burst);
+    QXMutex lock;
+    lock.init(QF_MAX_ACTIVE);
+    lock.lock();
+    for (uint32_t i = 0; i < ACTIVATION_EVT_COUNT; i++) {
+        act->POST(&benchEvt, sender);
+    }
+    uint32_t start = GetCycleCnt();
+    lock.unlock();
+    uint32_t cycles = GetCycleCnt() - start;
+    act->setBurst(savedBurst);
+    return cycles / ACTIVATION_EVT_COUNT;
+}
+
+void Bench::ActivationCost(QActive const *sender) {
+    QActive *act = QF::active_[PRIO_UART2_ACT];
+    Q_ASSERT(act && (act->getPrio() > sender->getPrio()));
+    uint32_t cycles1 = MeasureActivation(act, 1, sender);
+    uint32_t cyclesN = MeasureActivation(act, ACTIVATION_EVT_COUNT, sender);
+    uint32_t cyclePerUs = GetCyclePerUs();
+    PRINT("Bench: activation burst=1 %lucyc(%luns)/evt\n\r", cycles1, cycles1 * 1000 / cyclePerUs);
+    PRINT("Bench: activation burst=%u %lucyc(%luns)/evt\n\r", ACTIVATION_EVT_COUNT, cyclesN,
+          cyclesN * 1000 / cyclePerUs);
+}
+
+#ifdef BENCH_TICK_COST
+// Arm count time events, tick TICK_ITER_COUNT times and disarm them all.
+// Returns the average number of cycles per arm, per tick and per disarm.
+void Bench::MeasureTick(QTimeEvt *timer, uint32_t count, uint32_t *armCycles, uint32_t *tickCycles,
+                        uint32_t *disarmCycles, QActive const *sender) {
+    (void)sender;   // Unused when Q_SPY is not defined.
+    uint32_t start = GetCycleCnt();
+    for (uint32_t i = 0; i < count; i++) {
+        timer[i].armX(TICK_ITER_COUNT + 1 + (i * 7919) % TICK_TIMEOUT_SPREAD);
+    }
+    *armCycles = (GetCycleCnt() - start) / count;
+    start = GetCycleCnt();
+    for (uint32_t i = 0; i < TICK_ITER_COUNT; i++) {
+        QF::TICK_X(TICK_RATE, sender);
+    }
+    *tickCycles = (GetCycleCnt() - start) / TICK_ITER_COUNT;
+    start = GetCycleCnt();
+    for (uint32_t i = 0; i < count; i++) {
+        timer[i].disarm();
+    }
+    *disarmCycles = (GetCycleCnt() - start) / count;
+}
+
+void Bench::TickCost(QActive *owner) {
+    static uint32_t const timerCount[] = { 10, 100, TICK_TIMER_COUNT_MAX };
+    // The time events are constructed on first use since their owner is not
+    // known before then. QTimeEvt has no public default constructor, so they
+    // are placed into raw storage. uint64_t aligns them on the host too.
+    static uint64_t timerStor[(TICK_TIMER_COUNT_MAX * sizeof(QTimeEvt) + sizeof(uint64_t) - 1) / sizeof(uint64_t)];
+    static QTimeEvt *timer = NULL;
+    Q_ASSERT(owner && (TICK_RATE < QF_MAX_TICK_RATE));
+    if (timer == NULL) {
+        timer = reinterpret_cast<QTimeEvt *>(timerStor);
+        for (uint32_t i = 0; i < TICK_TIMER_COUNT_MAX; i++) {
+            new (&timer[i]) QTimeEvt(owner, SYSTEM_BENCH, TICK_RATE);
+        }
+    }
+    uint32_t cyclePerUs = GetCyclePerUs();
+    for (uint32_t i = 0; i < ARRAY_COUNT(timerCount); i++) {
+        uint32_t armCycles, tickCycles, disarmCycles;
+        MeasureTick(timer, timerCount[i], &armCycles, &tickCycles, &disarmCycles, owner);
+        PRINT("Bench: timers=%lu arm %lucyc tick %lucyc(%luns) disarm %lucyc\n\r", timerCount[i], armCycles,
+              tickCycles, tickCycles * 1000 / cyclePerUs, disarmCycles);
+    }
+}
+#endif // BENCH_TICK_COST
+
+} // namespace APP
@@ -0,0 +1,84 @@
+/*******************************************************************************
+ * Copyright (C) 2017 Gallium Studio LLC (Lawrence Lo). All rights reserved. 
+ * All rights reserved.
+ *
+ * This program is open source software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ******************************************************************************/
+
+#ifndef BENCH_H
+#define BENCH_H
+
+#include "qpcpp.h"
+
+using namespace QP;
+
+// Define to build Bench::TickCost(). Its time events take about 32KB of RAM
+// for good, a third of the RAM of the target, so it is only enabled on demand
+// there. The host build defines it in its Makefile.
+//#define BENCH_TICK_COST
+
+namespace APP {
+
+// Microbenchmarks measured with the DWT cycle counter. Results are printed via PRINT.
+// They must be run from an AO and with a free system (e.g. upon user request),
+// since other AOs may receive benchmark events.
+class Bench {
+public:
+    // Cost of QF::PUBLISH() with 0, 1 and N subscribers.
+    static void PublishCost(QActive const *sender);
+    // Cost per event of activating an AO and dispatching a burst of queued
+    // events to it, with and without burst mode (see QActive::setBurst()).
+    static void ActivationCost(QActive const *sender);
+#ifdef BENCH_TICK_COST
+    // Cost of arming, disarming and ticking with 10, 100 and 1000 armed time
+    // events. The time events belong to owner but never expire during the run.
+    static void TickCost(QActive *owner);
+#endif
+
+protected:
+    enum {
+        // Each subscriber receives this number of events per run, so it must
+        // be well below the event queue size of the subscribers.
+        PUBLISH_ITER_COUNT = 8,
+        ACTIVATION_EVT_COUNT = 8,
+        // Spare tick rate not driven by SysTick, so that it can be ticked here.
+        TICK_RATE = 1,
+        TICK_ITER_COUNT = 64,
+        TICK_TIMER_COUNT_MAX = 1000,
+        // Timeouts are spread over this many ticks beyond TICK_ITER_COUNT,
+        // so that some time events cascade but none expires.
+        TICK_TIMEOUT_SPREAD = 10000
+    };
+    static uint32_t MeasurePublish(QActive const *sender);
+    static uint32_t MeasureActivation(QActive *act, uint8_t burst, QActive const *sender);
+#ifdef BENCH_TICK_COST
+    static void MeasureTick(QTimeEvt *timer, uint32_t count, uint32_t *armCycles, uint32_t *tickCycles,
+                            uint32_t *disarmCycles, QActive const *sender);
+#endif
+};
+
+} // namespace APP
+
+#endif // BENCH_H
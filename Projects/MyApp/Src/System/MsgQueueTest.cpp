@@ -0,0 +1,166 @@
+/*******************************************************************************
+ * Copyright (C) 2017 Gallium Studio LLC (Lawrence Lo). All rights reserved. 
+ * All rights reserved.
+ *
+ * This program is open source software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ******************************************************************************/
+
+
+#include "qpcpp.h"
+#include "bsp.h"
+#include "fw_macro.h"
+#include "fw_log.h"
+#include "fw_stack.h"
+#include "MsgQueueTest.h"
+
+Q_DEFINE_THIS_FILE
+
+using namespace FW;
+
+namespace APP {
+
+QXThread MsgQueueTest::m_consumer(&MsgQueueTest::ConsumerThread, 0);
+QXThread MsgQueueTest::m_producer(&MsgQueueTest::ProducerThread, 0);
+QXSemaphore MsgQueueTest::m_consumerSema;
+QXSemaphore MsgQueueTest::m_producerSema;
+MsgQueueTest::Queue MsgQueueTest::m_queue;
+bool MsgQueueTest::m_started = false;
+bool volatile MsgQueueTest::m_running = false;
+uint32_t volatile MsgQueueTest::m_checks = 0;
+uint32_t volatile MsgQueueTest::m_roundCount = 0;
+uint32_t volatile MsgQueueTest::m_lastChecks = 0;
+uint64_t MsgQueueTest::m_consumerStk[STACK_SIZE / sizeof(uint64_t)];
+uint64_t MsgQueueTest::m_producerStk[STACK_SIZE / sizeof(uint64_t)];
+
+void MsgQueueTest::Start(uint8_t prio) {
+#ifdef QXK_NO_XTHREAD
+    // Not supported by the port (e.g. POSIX). Report() tells so.
+    (void)prio;
+    return;
+#endif
+    m_consumerSema.init(0);
+    m_producerSema.init(0);
+    m_producer.start(prio, NULL, 0, m_producerStk, sizeof(m_producerStk));
+    m_consumer.start(prio + 1, NULL, 0, m_consumerStk, sizeof(m_consumerStk));
+    StackStats::Register(&m_producer, "MSGQ_PRODUCER");
+    StackStats::Register(&m_consumer, "MSGQ_CONSUMER");
+    m_started = true;
+}
+
+// Runs above both threads, so the queue is empty and neither thread is
+// blocked on it when m_running is false.
+void MsgQueueTest::Run() {
+    if (!m_started || m_running) {
+        return;
+    }
+    m_running = true;
+    m_checks = 0;
+    bool filled = true;
+    for (uint32_t i = 0; i < DEPTH; i++) {
+        filled = m_queue.Put(MSG_AO + i) && filled;
+    }
+    if (filled && !m_queue.Put(MSG_AO + DEPTH)) {
+        m_checks = m_checks | CHECK_AO_FULL;
+    }
+    // The consumer runs first and waits for the producer to block.
+    m_consumerSema.signal();
+    m_producerSema.signal();
+}
+
+void MsgQueueTest::Report() {
+    if (!m_started) {
+        PRINT("MsgQueueTest: not started\n\r");
+        return;
+    }
+    // ConsumerThread() may update both in between if called below its priority.
+    uint32_t count;
+    uint32_t checks;
+    do {
+        count = m_roundCount;
+        checks = m_lastChecks;
+    } while (count != m_roundCount);
+    if (count == 0) {
+        PRINT("MsgQueueTest: no round completed\n\r");
+        return;
+    }
+    PRINT("MsgQueueTest: round=%lu aoFull=%u putTimeout=%u order=%u %s\n\r", count,
+          (checks & CHECK_AO_FULL) != 0, (checks & CHECK_PUT_TIMEOUT) != 0, (checks & CHECK_ORDER) != 0,
+          (checks == CHECK_ALL) ? "PASS" : "FAIL");
+}
+
+void MsgQueueTest::Delay(uint32_t ms) {
+    QXThread::delay(static_cast<uint_fast16_t>(ROUND_UP_DIV(ms, BSP_MSEC_PER_TICK)), 0);
+}
+
+void MsgQueueTest::ConsumerThread(QXThread * const me) {
+    (void)me;
+    for (;;) {
+        m_consumerSema.wait(QXTHREAD_NO_TIMEOUT, 0);
+        // Let the producer time out on the full queue and block in Put().
+        Delay(SETTLE_MS);
+        uint32_t msg = 0;
+        bool ok = m_queue.Get(msg) && (msg == MSG_AO);
+        // Refill the slot before the woken producer runs.
+        ok = m_queue.Put(MSG_CONSUMER) && ok;
+        Delay(SETTLE_MS);
+        // Expect the other AO message, ours, then those of the producer, for
+        // which this thread blocks on the empty queue.
+        uint32_t expected[DEPTH + PRODUCER_COUNT];
+        uint32_t n = 0;
+        for (uint32_t i = 1; i < DEPTH; i++) {
+            expected[n++] = MSG_AO + i;
+        }
+        expected[n++] = MSG_CONSUMER;
+        for (uint32_t i = 0; i < PRODUCER_COUNT; i++) {
+            expected[n++] = MSG_PRODUCER + i;
+        }
+        uint32_t count = 0;
+        while (m_queue.Get(msg, GET_TIMEOUT_MS)) {
+            ok = ok && (count < n) && (msg == expected[count]);
+            count++;
+        }
+        if (ok && (count == n)) {
+            m_checks = m_checks | CHECK_ORDER;
+        }
+        m_lastChecks = m_checks;
+        m_roundCount = m_roundCount + 1;
+        m_running = false;
+    }
+}
+
+void MsgQueueTest::ProducerThread(QXThread * const me) {
+    (void)me;
+    for (;;) {
+        m_producerSema.wait(QXTHREAD_NO_TIMEOUT, 0);
+        if (!m_queue.Put(MSG_PRODUCER, PUT_TIMEOUT_MS)) {
+            m_checks = m_checks | CHECK_PUT_TIMEOUT;
+        }
+        for (uint32_t i = 0; i < PRODUCER_COUNT; i++) {
+            (void)m_queue.Put(MSG_PRODUCER + i);
+        }
+    }
+}
+
+} // namespace APP
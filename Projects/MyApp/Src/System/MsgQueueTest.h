@@ -0,0 +1,105 @@
+/*******************************************************************************
+ * Copyright (C) 2017 Gallium Studio LLC (Lawrence Lo). All rights reserved. 
+ * All rights reserved.
+ *
+ * This program is open source software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ******************************************************************************/
+
+
+#ifndef MSG_QUEUE_TEST_H
+#define MSG_QUEUE_TEST_H
+
+#include "qpcpp.h"
+#include "fw_msgq.h"
+
+using namespace QP;
+
+namespace APP {
+
+// On-target check of QXMsgQueue (via FW::MsgQueue), with a consumer thread at
+// prio + 1 and a producer thread at prio. In each round started by Run():
+// - The calling AO fills the queue and checks that one more Put() fails.
+// - The producer checks that a Put() into the full queue times out, then
+//   blocks in Put() until the consumer frees a slot.
+// - The consumer takes a message and puts one back before the producer runs,
+//   so the woken producer blocks again.
+// - The producer then puts PRODUCER_COUNT messages while the consumer blocks
+//   in Get() on the empty queue, and the consumer checks that all arrive in
+//   order before its last Get() times out.
+// Like MutexTest, the threads do not log and Report() prints the result of
+// the last round.
+class MsgQueueTest {
+public:
+    static void Start(uint8_t prio);
+    // Can be called from an AO. Has no effect if Start() has not been called
+    // (e.g. on the host, which does not support extended threads) or if the
+    // last round is still running.
+    static void Run();
+    static void Report();
+
+protected:
+    enum {
+        DEPTH = 2,
+        PRODUCER_COUNT = 8,
+        // The producer must time out and block again within SETTLE_MS.
+        PUT_TIMEOUT_MS = 5,
+        SETTLE_MS = 20,
+        GET_TIMEOUT_MS = 20,
+        // Message values.
+        MSG_AO = 0x100,         // + index
+        MSG_CONSUMER = 0x200,
+        MSG_PRODUCER = 0x300,   // + index
+        // As MutexTest. Check with StackStats.
+        STACK_SIZE = 512
+    };
+    enum {
+        CHECK_AO_FULL = 0x1,        // Put() by the AO failed on a full queue.
+        CHECK_PUT_TIMEOUT = 0x2,    // Put() by the producer timed out.
+        CHECK_ORDER = 0x4,          // The consumer got all messages in order.
+        CHECK_ALL = 0x7
+    };
+    typedef FW::MsgQueue<uint32_t, DEPTH> Queue;
+
+    static void ConsumerThread(QXThread * const me);
+    static void ProducerThread(QXThread * const me);
+    static void Delay(uint32_t ms);
+
+    static QXThread m_consumer;
+    static QXThread m_producer;
+    static QXSemaphore m_consumerSema;
+    static QXSemaphore m_producerSema;
+    static Queue m_queue;
+    static bool m_started;
+    static bool volatile m_running;
+    static uint32_t volatile m_checks;      // CHECK_xxx passed in this round.
+    static uint32_t volatile m_roundCount;  // Completed rounds.
+    static uint32_t volatile m_lastChecks;  // CHECK_xxx passed in the last round.
+    static uint64_t m_consumerStk[STACK_SIZE / sizeof(uint64_t)];
+    static uint64_t m_producerStk[STACK_SIZE / sizeof(uint64_t)];
+};
+
+} // namespace APP
+
+#endif // MSG_QUEUE_TEST_H
@@ -0,0 +1,144 @@
+/*******************************************************************************
+ * Copyright (C) 2017 Gallium Studio LLC (Lawrence Lo). All rights reserved. 
+ * All rights reserved.
+ *
+ * This program is open source software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ******************************************************************************/
+
+#include "qpcpp.h"
+#include "bsp.h"
+#include "fw_macro.h"
+#include "fw_log.h"
+#include "fw_stack.h"
+#include "MutexTest.h"
+
+Q_DEFINE_THIS_FILE
+
+using namespace FW;
+
+namespace APP {
+
+QXThread MutexTest::m_low(&MutexTest::LowThread, 0);
+QXThread MutexTest::m_mid(&MutexTest::MidThread, 0);
+QXThread MutexTest::m_high(&MutexTest::HighThread, 0);
+QXSemaphore MutexTest::m_lowSema;
+QXSemaphore MutexTest::m_midSema;
+QXSemaphore MutexTest::m_highSema;
+QXPiMutex MutexTest::m_mutex;
+bool MutexTest::m_started = false;
+uint32_t volatile MutexTest::m_roundCount = 0;
+uint32_t volatile MutexTest::m_blockedUs = 0;
+uint64_t MutexTest::m_lowStk[STACK_SIZE / sizeof(uint64_t)];
+uint64_t MutexTest::m_midStk[STACK_SIZE / sizeof(uint64_t)];
+uint64_t MutexTest::m_highStk[STACK_SIZE / sizeof(uint64_t)];
+
+void MutexTest::Start(uint8_t prio) {
+#ifdef QXK_NO_XTHREAD
+    // Not supported by the port (e.g. POSIX). Report() tells so.
+    (void)prio;
+    return;
+#endif
+    m_lowSema.init(0);
+    m_midSema.init(0);
+    m_highSema.init(0);
+    m_mutex.init();
+    m_low.start(prio, NULL, 0, m_lowStk, sizeof(m_lowStk));
+    m_mid.start(prio + 1, NULL, 0, m_midStk, sizeof(m_midStk));
+    m_high.start(prio + 2, NULL, 0, m_highStk, sizeof(m_highStk));
+    StackStats::Register(&m_low, "MUTEX_LOW");
+    StackStats::Register(&m_mid, "MUTEX_MID");
+    StackStats::Register(&m_high, "MUTEX_HIGH");
+    m_started = true;
+}
+
+void MutexTest::Run() {
+    if (m_started) {
+        m_lowSema.signal();
+    }
+}
+
+void MutexTest::Report() {
+    if (!m_started) {
+        PRINT("MutexTest: not started\n\r");
+        return;
+    }
+    // HighThread() may update both in between if called below its priority.
+    uint32_t count;
+    uint32_t blockedUs;
+    do {
+        count = m_roundCount;
+        blockedUs = m_blockedUs;
+    } while (count != m_roundCount);
+    if (count == 0) {
+        PRINT("MutexTest: no round completed\n\r");
+        return;
+    }
+    PRINT("MutexTest: round=%lu blocked=%luus hold=%uus hog=%uus %s\n\r", count, blockedUs, HOLD_US, HOG_US,
+          (blockedUs <= (HOLD_US + MARGIN_US)) ? "PASS" : "FAIL");
+}
+
+void MutexTest::Spin(uint32_t us) {
+    uint32_t cycles = us * GetCyclePerUs();
+    uint32_t start = GetCycleCnt();
+    while ((GetCycleCnt() - start) < cycles) {
+    }
+}
+
+// Takes the mutex, then wakes the high thread (which preempts and blocks on
+// the mutex) and the medium thread (which must not preempt the boosted holder).
+void MutexTest::LowThread(QXThread * const me) {
+    (void)me;
+    for (;;) {
+        m_lowSema.wait(QXTHREAD_NO_TIMEOUT, 0);
+        m_mutex.lock();
+        m_highSema.signal();
+        m_midSema.signal();
+        Spin(HOLD_US);
+        m_mutex.unlock();
+    }
+}
+
+void MutexTest::MidThread(QXThread * const me) {
+    (void)me;
+    for (;;) {
+        m_midSema.wait(QXTHREAD_NO_TIMEOUT, 0);
+        Spin(HOG_US);
+    }
+}
+
+void MutexTest::HighThread(QXThread * const me) {
+    (void)me;
+    for (;;) {
+        m_highSema.wait(QXTHREAD_NO_TIMEOUT, 0);
+        uint32_t start = GetCycleCnt();
+        m_mutex.lock();
+        uint32_t blockedUs = (GetCycleCnt() - start) / GetCyclePerUs();
+        m_mutex.unlock();
+        m_blockedUs = blockedUs;
+        m_roundCount = m_roundCount + 1;
+    }
+}
+
+} // namespace APP
@@ -0,0 +1,85 @@
+/*******************************************************************************
+ * Copyright (C) 2017 Gallium Studio LLC (Lawrence Lo). All rights reserved. 
+ * All rights reserved.
+ *
+ * This program is open source software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ******************************************************************************/
+
+#ifndef MUTEX_TEST_H
+#define MUTEX_TEST_H
+
+#include "qpcpp.h"
+
+using namespace QP;
+
+namespace APP {
+
+// On-target check that QXPiMutex bounds the blocking time of a high priority
+// thread by the time a low priority thread holds the mutex, while a medium
+// priority thread hogs the CPU. Without priority inheritance the high thread
+// would also wait for the hog. Three extended threads at prio, prio + 1 and
+// prio + 2 run one round per Run(). They do not log themselves, which keeps
+// their stacks small, Report() prints the result of the last round instead.
+class MutexTest {
+public:
+    static void Start(uint8_t prio);
+    // Can be called from an AO. Has no effect if Start() has not been called
+    // (e.g. on the host, which does not support extended threads).
+    static void Run();
+    static void Report();
+
+protected:
+    enum {
+        HOLD_US = 2000,
+        HOG_US = 20000,
+        // Allowance for preemption by AOs and ISRs while holding.
+        MARGIN_US = 500,
+        // The threads only spin and block. This covers the exception frame
+        // (with FPU context) and the QXK context. Check with StackStats.
+        STACK_SIZE = 512
+    };
+    static void LowThread(QXThread * const me);
+    static void MidThread(QXThread * const me);
+    static void HighThread(QXThread * const me);
+    static void Spin(uint32_t us);
+
+    static QXThread m_low;
+    static QXThread m_mid;
+    static QXThread m_high;
+    static QXSemaphore m_lowSema;
+    static QXSemaphore m_midSema;
+    static QXSemaphore m_highSema;
+    static QXPiMutex m_mutex;
+    static bool m_started;
+    static uint32_t volatile m_roundCount;  // Completed rounds.
+    static uint32_t volatile m_blockedUs;   // Blocking time in the last round.
+    static uint64_t m_lowStk[STACK_SIZE / sizeof(uint64_t)];
+    static uint64_t m_midStk[STACK_SIZE / sizeof(uint64_t)];
+    static uint64_t m_highStk[STACK_SIZE / sizeof(uint64_t)];
+};
+
+} // namespace APP
+
+#endif // MUTEX_TEST_H
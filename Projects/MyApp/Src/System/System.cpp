@@ -30,13 +30,21 @@
 #include "qpcpp.h"
 #include "fw_log.h"
 #include "fw_evt.h"
+#include "fw_tracker.h"
+#include "fw_latency.h"
+#include "fw_stack.h"
+#include "fw_schedtrace.h"
 #include "hsm_id.h"
 #include "System.h"
+#include "Bench.h"
+#include "MutexTest.h"
+#include "MsgQueueTest.h"
 #include "event.h"
 // Test only.
 #include "Test.h"
 #include "stm32f4xx_hal.h"
 #include "stm32f4xx_nucleo.h"
+#include "stm32f4xx_it.h"
 
 Q_DEFINE_THIS_FILE
 
@@ -47,26 +55,48 @@ void LCD_Config(void);
 
 namespace APP {
 
+// Every request times out in m_trans (SYSTEM_TRANS_TIMER) within half the
+// timeout of the start or stop of System, as each takes two states.
+Q_ASSERT_COMPILE((SystemStartReq::TIMEOUT_MS / 2) > UartActStartReq::TIMEOUT_MS);
+Q_ASSERT_COMPILE((SystemStartReq::TIMEOUT_MS / 2) > UserLedStartReq::TIMEOUT_MS);
+Q_ASSERT_COMPILE((SystemStartReq::TIMEOUT_MS / 2) > UserBtnStartReq::TIMEOUT_MS);
+Q_ASSERT_COMPILE((SystemStopReq::TIMEOUT_MS / 2) > UartActStopReq::TIMEOUT_MS);
+Q_ASSERT_COMPILE((SystemStopReq::TIMEOUT_MS / 2) > UserLedStopReq::TIMEOUT_MS);
+Q_ASSERT_COMPILE((SystemStopReq::TIMEOUT_MS / 2) > UserBtnStopReq::TIMEOUT_MS);
+
 System::System() :
     QActive((QStateHandler)&System::InitialPseudoState), 
     m_id(SYSTEM), m_name("SYSTEM"), m_nextSequence(0),
+    m_trans(m_transStor, ARRAY_COUNT(m_transStor), m_transTimer),
     m_uart2OutFifo(m_uart2OutFifoStor, UART_OUT_FIFO_ORDER),
     m_uart2InFifo(m_uart2InFifoStor, UART_IN_FIFO_ORDER),
-    m_stateTimer(this, SYSTEM_STATE_TIMER),
-    m_testTimer(this, SYSTEM_TEST_TIMER) {}
+    m_transTimer(this, SYSTEM_TRANS_TIMER),
+    m_testTimer(this, SYSTEM_TEST_TIMER),
+    m_statsTimer(this, SYSTEM_STATS_TIMER),
+    m_traceTimer(this, SYSTEM_TRACE_TIMER), m_traceIndex(0),
+    m_reportTimer(this, SYSTEM_REPORT_TIMER), m_reportStep(0),
+    m_leakTimer(this, SYSTEM_LEAK_TIMER) {}
 
 QState System::InitialPseudoState(System * const me, QEvt const * const e) {
     (void)e;
     me->m_deferQueue.init(me->m_deferQueueStor, ARRAY_COUNT(me->m_deferQueueStor));
+    QueueStats::Register(&me->m_deferQueue, me->m_name, me->getPrio(), QueueStats::TYPE_DEFER);
+    RtcBudget::SetReport(me, SYSTEM_RTC_OVERRUN);
 
     me->subscribe(SYSTEM_START_REQ);
     me->subscribe(SYSTEM_STOP_REQ);
-    me->subscribe(SYSTEM_STATE_TIMER);
+    me->subscribe(SYSTEM_TRANS_TIMER);
     me->subscribe(SYSTEM_TEST_TIMER);
+    me->subscribe(SYSTEM_STATS_TIMER);
+    me->subscribe(SYSTEM_TRACE_TIMER);
+    me->subscribe(SYSTEM_REPORT_TIMER);
+    me->subscribe(SYSTEM_LEAK_TIMER);
+    me->subscribe(SYSTEM_QUEUE_STATS_IND);
+    me->subscribe(SYSTEM_CPU_LOAD_IND);
     me->subscribe(SYSTEM_DONE);
     me->subscribe(SYSTEM_FAIL);
     me->subscribe(UART_ACT_START_CFM);
-    me->subscribe(UART_IN_CHAR_IND);
+    me->subscribe(UART_IN_DATA_IND);
     me->subscribe(USER_BTN_START_CFM);
     me->subscribe(USER_BTN_UP_IND);
     me->subscribe(USER_BTN_DOWN_IND);
@@ -109,6 +139,28 @@ QState System::Root(System * const me, QEvt const * const e) {
             status = Q_TRAN(&System::Stopping2);
             break;
         }
+        case SYSTEM_RTC_OVERRUN: {
+            // State handler addresses can be looked up in the linker map.
+            RtcBudget::Entry entry[RtcBudget::MAX_ENTRY];
+            uint32_t count = RtcBudget::Snapshot(entry, ARRAY_COUNT(entry));
+            for (uint32_t i = 0; i < count; i++) {
+                RtcBudget::Entry const &o = entry[i];
+                DEBUG("RtcOverrun prio=%d sig=%s state=%p n=%d max=%luus budget=%luus", o.m_prio,
+                      GetEvtName(o.m_sig), reinterpret_cast<void *>(o.m_state), o.m_count, o.m_maxUs,
+                      o.m_budgetUs);
+            }
+            status = Q_HANDLED();
+            break;
+        }
+        case SYSTEM_TRANS_TIMER: {
+            LOG_EVENT(e);
+            if (me->m_trans.HandleTimeout()) {
+                Evt *evt = new SystemFail(ERROR_TIMEOUT, 0);
+                me->postCtrl(evt);
+            }
+            status = Q_HANDLED();
+            break;
+        }
         default: {
             status = Q_SUPER(&QHsm::top);
             break;
@@ -158,42 +210,39 @@ QState System::Starting1(System * const me, QEvt const * const e) {
     switch (e->sig) {
         case Q_ENTRY_SIG: {
             LOG_EVENT(e);
-            uint32_t timeout = SystemStartReq::TIMEOUT_MS / 2;
-            Q_ASSERT(timeout > UartActStartReq::TIMEOUT_MS);
-            me->m_stateTimer.armX(timeout);
-            me->m_cfmCount = 0;
-            
+            me->m_trans.Reset();
+
             Evt *evt = new UartActStartReq(me->m_nextSequence++, &me->m_uart2OutFifo, &me->m_uart2InFifo);
-            // TODO - Save sequence for comparison.
-            QF::PUBLISH(evt, me);
+            me->SendReq(evt, UART_ACT_START_CFM, GROUP_UART, UartActStartReq::TIMEOUT_MS);
+            // UserLed and UserBtn do not depend on UART. Start them in parallel and
+            // only wait for them in Starting2.
+            evt = new UserLedStartReq(me->m_nextSequence++);
+            me->SendReq(evt, USER_LED_START_CFM, GROUP_IO, UserLedStartReq::TIMEOUT_MS);
+            evt = new UserBtnStartReq(me->m_nextSequence++);
+            me->SendReq(evt, USER_BTN_START_CFM, GROUP_IO, UserBtnStartReq::TIMEOUT_MS);
             status = Q_HANDLED();
             break;
         }
         case Q_EXIT_SIG: {
             LOG_EVENT(e);
-            me->m_stateTimer.disarm();
             status = Q_HANDLED();
             break;
         }
-        case UART_ACT_START_CFM: {
+        case UART_ACT_START_CFM:
+        case USER_LED_START_CFM:
+        case USER_BTN_START_CFM: {
             LOG_EVENT(e);
-            me->HandleCfm(ERROR_EVT_CAST(*e), 1);
+            me->HandleCfm(ERROR_EVT_CAST(*e), GROUP_UART);
             status = Q_HANDLED();
             break;
         }
-        case SYSTEM_FAIL:
-        case SYSTEM_STATE_TIMER: {
+        case SYSTEM_FAIL: {
             LOG_EVENT(e);
-            Evt *evt;
-            if (e->sig == SYSTEM_FAIL) {
-                ErrorEvt const &fail = ERROR_EVT_CAST(*e);
-                evt = new SystemStartCfm(me->m_savedInSeq,
-                                         fail.GetError(), fail.GetReason());
-            } else {
-                evt = new SystemStartCfm(me->m_savedInSeq, ERROR_TIMEOUT);
-            }
+            ErrorEvt const &fail = ERROR_EVT_CAST(*e);
+            Evt *evt = new SystemStartCfm(me->m_savedInSeq,
+                                          fail.GetError(), fail.GetReason());
             QF::PUBLISH(evt, me);
-            status = Q_TRAN(&System::Stopping1);
+            status = Q_TRAN(&System::Stopping2);
             break;
         }
         case SYSTEM_DONE: {
@@ -215,45 +264,31 @@ QState System::Starting2(System * const me, QEvt const * const e) {
     switch (e->sig) {
         case Q_ENTRY_SIG: {
             LOG_EVENT(e);
-            uint32_t timeout = SystemStartReq::TIMEOUT_MS / 2;
-            Q_ASSERT(timeout > UserLedStartReq::TIMEOUT_MS);
-            Q_ASSERT(timeout > UserBtnStartReq::TIMEOUT_MS);
-            me->m_stateTimer.armX(timeout);
-            me->m_cfmCount = 0;
-            
-            Evt *evt = new UserLedStartReq(me->m_nextSequence++);
-            // TODO - Save sequence number for comparison.
-            QF::PUBLISH(evt, me);
-            evt = new UserBtnStartReq(me->m_nextSequence++);
-            // TODO - Save sequence number for comparison.
-            QF::PUBLISH(evt, me);
+            // UserLed and UserBtn were started in Starting1 and may have confirmed already.
+            if (me->m_trans.IsGroupDone(GROUP_IO)) {
+                Evt *evt = new Evt(SYSTEM_DONE);
+                me->postCtrl(evt);
+            }
             status = Q_HANDLED();
             break;
         }
         case Q_EXIT_SIG: {
             LOG_EVENT(e);
-            me->m_stateTimer.disarm();
             status = Q_HANDLED();
             break;
         }
         case USER_LED_START_CFM:
         case USER_BTN_START_CFM: {
             LOG_EVENT(e);
-            me->HandleCfm(ERROR_EVT_CAST(*e), 2);
+            me->HandleCfm(ERROR_EVT_CAST(*e), GROUP_IO);
             status = Q_HANDLED();
             break;
         }
-        case SYSTEM_FAIL:
-        case SYSTEM_STATE_TIMER: {
+        case SYSTEM_FAIL: {
             LOG_EVENT(e);
-            Evt *evt;
-            if (e->sig == SYSTEM_FAIL) {
-                ErrorEvt const &fail = ERROR_EVT_CAST(*e);
-                evt = new SystemStartCfm(me->m_savedInSeq,
-                                         fail.GetError(), fail.GetReason());
-            } else {
-                evt = new SystemStartCfm(me->m_savedInSeq, ERROR_TIMEOUT);
-            }
+            ErrorEvt const &fail = ERROR_EVT_CAST(*e);
+            Evt *evt = new SystemStartCfm(me->m_savedInSeq,
+                                          fail.GetError(), fail.GetReason());
             QF::PUBLISH(evt, me);
             status = Q_TRAN(&System::Stopping2);
             break;
@@ -278,22 +313,18 @@ QState System::Stopping1(System * const me, QEvt const * const e) {
     switch (e->sig) {
         case Q_ENTRY_SIG: {
             LOG_EVENT(e);
-            uint32_t timeout = SystemStopReq::TIMEOUT_MS / 2;
-            Q_ASSERT(timeout > UartActStopReq::TIMEOUT_MS);
-            me->m_stateTimer.armX(timeout);
-            me->m_cfmCount = 0;
+            me->m_trans.Reset();
 
             Log::DeleteInterface();            
             Evt *evt = new UartActStopReq(me->m_nextSequence++);
-            QF::PUBLISH(evt, me);
+            me->SendReq(evt, UART_ACT_STOP_CFM, GROUP_UART, UartActStopReq::TIMEOUT_MS);
             status = Q_HANDLED();
             break;
         }
         case Q_EXIT_SIG: {
             LOG_EVENT(e);
-            me->m_stateTimer.disarm();
-            // recall event
-            me->recall(&me->m_deferQueue);
+            // recall all deferred events
+            me->recallAll(&me->m_deferQueue);
             status = Q_HANDLED();            
             break;
         }
@@ -306,12 +337,11 @@ QState System::Stopping1(System * const me, QEvt const * const e) {
         }
         case UART_ACT_STOP_CFM: {
             LOG_EVENT(e);
-            me->HandleCfm(ERROR_EVT_CAST(*e), 1);
+            me->HandleCfm(ERROR_EVT_CAST(*e), GROUP_UART);
             status = Q_HANDLED();
             break;
         }
-        case SYSTEM_FAIL:
-        case SYSTEM_STATE_TIMER: {
+        case SYSTEM_FAIL: {
             LOG_EVENT(e);
             Q_ASSERT(0);
             // Will not reach here.
@@ -338,24 +368,19 @@ QState System::Stopping2(System * const me, QEvt const * const e) {
     switch (e->sig) {
         case Q_ENTRY_SIG: {
             LOG_EVENT(e);
-            uint32_t timeout = SystemStopReq::TIMEOUT_MS / 2;
-            Q_ASSERT(timeout > UserLedStopReq::TIMEOUT_MS);
-            Q_ASSERT(timeout > UserBtnStopReq::TIMEOUT_MS);
-            me->m_stateTimer.armX(timeout);
-            me->m_cfmCount = 0;
+            me->m_trans.Reset();
 
             Evt *evt = new UserLedStopReq(me->m_nextSequence++);
-            QF::PUBLISH(evt, me);
+            me->SendReq(evt, USER_LED_STOP_CFM, GROUP_IO, UserLedStopReq::TIMEOUT_MS);
             evt = new UserBtnStopReq(me->m_nextSequence++);
-            QF::PUBLISH(evt, me);
+            me->SendReq(evt, USER_BTN_STOP_CFM, GROUP_IO, UserBtnStopReq::TIMEOUT_MS);
             status = Q_HANDLED();
             break;
         }
         case Q_EXIT_SIG: {
             LOG_EVENT(e);
-            me->m_stateTimer.disarm();
-            // recall event
-            me->recall(&me->m_deferQueue);
+            // recall all deferred events
+            me->recallAll(&me->m_deferQueue);
             status = Q_HANDLED();
             break;
         }
@@ -369,12 +394,11 @@ QState System::Stopping2(System * const me, QEvt const * const e) {
         case USER_LED_STOP_CFM:
         case USER_BTN_STOP_CFM: {
             LOG_EVENT(e);
-            me->HandleCfm(ERROR_EVT_CAST(*e), 2);
+            me->HandleCfm(ERROR_EVT_CAST(*e), GROUP_IO);
             status = Q_HANDLED();
             break;
         }
-        case SYSTEM_FAIL:
-        case SYSTEM_STATE_TIMER: {
+        case SYSTEM_FAIL: {
             LOG_EVENT(e);
             Q_ASSERT(0);
             // Will not reach here.
@@ -399,7 +423,11 @@ QState System::Started(System * const me, QEvt const * const e) {
     switch (e->sig) {
         case Q_ENTRY_SIG: {
             LOG_EVENT(e);
-            me->m_testTimer.armX(2000, 2000);   
+            me->m_testTimer.armX(2000, 2000, TEST_TIMER_SLACK_MS);
+            me->m_statsTimer.armX(STATS_INTERVAL_MS, STATS_INTERVAL_MS, STATS_TIMER_SLACK_MS);
+#ifdef QF_EVT_TRACKER
+            me->m_leakTimer.armX(LEAK_REPORT_INTERVAL_MS, LEAK_REPORT_INTERVAL_MS, TEST_TIMER_SLACK_MS);
+#endif
             status = Q_HANDLED();
             break;
         }
@@ -407,6 +435,11 @@ QState System::Started(System * const me, QEvt const * const e) {
             LOG_EVENT(e);
             // Test only.
             me->m_testTimer.disarm();
+            me->m_statsTimer.disarm();
+            me->m_traceTimer.disarm();
+            me->m_reportTimer.disarm();
+            me->m_leakTimer.disarm();
+            SchedTrace::Unfreeze();
             status = Q_HANDLED();
             break;
         }
@@ -424,7 +457,102 @@ QState System::Started(System * const me, QEvt const * const e) {
             pb->Print();
             pb = &td1;
             pb->Print();
-            
+            status = Q_HANDLED();
+            break;
+        }
+        case SYSTEM_LEAK_TIMER: {
+#ifdef QF_EVT_TRACKER
+            EvtTracker::ReportLeak(LEAK_THRESHOLD_MS);
+#endif
+            status = Q_HANDLED();
+            break;
+        }
+        case SYSTEM_STATS_TIMER: {
+            SystemQueueStatsInd *ind = new SystemQueueStatsInd(me->m_nextSequence++);
+            ind->Snapshot();
+            QF::PUBLISH(ind, me);
+            Evt *evt = new SystemCpuLoadInd(me->m_nextSequence++);
+            QF::PUBLISH(evt, me);
+            StackStats::Report();
+            status = Q_HANDLED();
+            break;
+        }
+        case SYSTEM_TRACE_TIMER: {
+            me->m_traceIndex = SchedTrace::Export(me->m_traceIndex, TRACE_EXPORT_COUNT);
+            if (me->m_traceIndex == 0) {
+                me->m_traceTimer.disarm();
+                SchedTrace::Unfreeze();
+            }
+            status = Q_HANDLED();
+            break;
+        }
+        case SYSTEM_REPORT_TIMER: {
+            // One report per timeout, so that its output fits into the log FIFO
+            // and a benchmark is not disturbed by the previous one.
+            switch (me->m_reportStep++) {
+                case REPORT_EVT_TRACKER: {
+#ifdef QF_EVT_TRACKER
+                    EvtTracker::ReportLatency();
+#endif
+                    break;
+                }
+                case REPORT_EVT_LATENCY: {
+#ifdef QF_EVT_LATENCY
+                    EvtLatency::Report();
+#endif
+                    break;
+                }
+                case REPORT_ISR_STAT: IsrStatReport(); break;
+                case REPORT_QUEUE_STATS: QueueStats::Report(); break;
+                case REPORT_BENCH_PUBLISH: Bench::PublishCost(me); break;
+                case REPORT_BENCH_ACTIVATION: Bench::ActivationCost(me); break;
+                case REPORT_BENCH_TICK: {
+#ifdef BENCH_TICK_COST
+                    Bench::TickCost(me);
+#endif
+                    break;
+                }
+                case REPORT_MSGQ_TEST: {
+                    // Like MutexTest, reported on the next press.
+                    MsgQueueTest::Report();
+                    MsgQueueTest::Run();
+                    break;
+                }
+                default: {
+                    // The round started here is reported on the next press.
+                    MutexTest::Report();
+                    MutexTest::Run();
+                    me->m_reportTimer.disarm();
+                    me->m_traceTimer.armX(TRACE_EXPORT_DELAY_MS, TRACE_EXPORT_INTERVAL_MS);
+                    break;
+                }
+            }
+            status = Q_HANDLED();
+            break;
+        }
+        case SYSTEM_QUEUE_STATS_IND: {
+            // Warn about queues that have been 3/4 full or have rejected posts.
+            SystemQueueStatsInd const &ind = static_cast<SystemQueueStatsInd const &>(*e);
+            for (uint8_t i = 0; i < ind.GetCount(); i++) {
+                QueueStats::Entry const &entry = ind.GetEntry(i);
+                uint32_t used = entry.m_capacity - entry.m_minFree;
+                if (entry.m_rejectCount || ((used * 4) >= (entry.m_capacity * 3U))) {
+                    DEBUG("Queue %s(%d) %s used=%lu/%d reject=%d", QueueStats::GetOwner(entry.m_index), entry.m_prio,
+                          QueueStats::GetTypeName(entry.m_type), used, entry.m_capacity, entry.m_rejectCount);
+                }
+            }
+            status = Q_HANDLED();
+            break;
+        }
+        case SYSTEM_CPU_LOAD_IND: {
+            // Priorities are listed in hsm_id.h. Idle includes sleep.
+            SystemCpuLoadInd const &ind = static_cast<SystemCpuLoadInd const &>(*e);
+            for (uint8_t i = 0; i < ind.GetCount(); i++) {
+                CpuLoad::Entry const &entry = ind.GetEntry(i);
+                char const *name = (entry.m_prio == CpuLoad::PRIO_ISR) ? "isr" : (entry.m_prio ? "prio" : "idle");
+                DEBUG("CpuLoad %s(%d) load=%d.%d%% maxRtc=%luus", name, entry.m_prio, entry.m_permille / 10,
+                      entry.m_permille % 10, entry.m_maxRtcUs);
+            }
             status = Q_HANDLED();
             break;
         }
@@ -437,6 +565,15 @@ QState System::Started(System * const me, QEvt const * const e) {
             }
         case USER_BTN_DOWN_IND: {
             LOG_EVENT(e);
+            // Keep the context switches leading up to the button press, before
+            // the benchmarks flood the ring. A press during the reports
+            // starts them over.
+            SchedTrace::Freeze();
+            me->m_traceIndex = 0;
+            me->m_traceTimer.disarm();
+            me->m_reportStep = REPORT_EVT_TRACKER;
+            me->m_reportTimer.disarm();
+            me->m_reportTimer.armX(REPORT_INTERVAL_MS, REPORT_INTERVAL_MS);
             Evt *evt = new UserLedOnReq(me->m_nextSequence++);
             QF::PUBLISH(evt, me);
             status = Q_HANDLED();
@@ -448,9 +585,12 @@ QState System::Started(System * const me, QEvt const * const e) {
             status = Q_HANDLED();
             break;    
         }
-        case UART_IN_CHAR_IND: {
-            UartInCharInd const &ind = static_cast<UartInCharInd const &>(*e);
-            DEBUG("Rx char %c", ind.GetChar());
+        case UART_IN_DATA_IND: {
+            UartInDataInd const &ind = static_cast<UartInDataInd const &>(*e);
+            UartInDataInd::Iterator it(ind);
+            while (it.HasNext()) {
+                DEBUG("Rx char %c", it.Next());
+            }
             status = Q_HANDLED();
             break;
         }
@@ -462,16 +602,25 @@ QState System::Started(System * const me, QEvt const * const e) {
     return status;
 }
 
-void System::HandleCfm(ErrorEvt const &e, uint8_t expectedCnt) {
+void System::SendReq(Evt *req, QSignal cfmSig, uint8_t group, uint32_t timeoutMs) {
+    m_trans.Add(req->GetSeq(), cfmSig, group, timeoutMs);
+    QF::PUBLISH(req, this);
+}
+
+// Post SYSTEM_DONE when all outstanding requests in waitGroup have been confirmed.
+void System::HandleCfm(ErrorEvt const &e, uint8_t waitGroup) {
+    if (!m_trans.Remove(e)) {
+        Log::Debug(m_name, __FUNCTION__, "Stale CFM %s(%d) seq=%d", GetEvtName(e.sig), e.sig, e.GetSeq());
+        return;
+    }
     if (e.GetError() == ERROR_SUCCESS) {
-        // TODO - Compare seqeuence number.
-        if(++m_cfmCount == expectedCnt) {
+        if (m_trans.IsGroupDone(waitGroup)) {
             Evt *evt = new Evt(SYSTEM_DONE);
-            postLIFO(evt);
+            postCtrl(evt);
         }
     } else {
         Evt *evt = new SystemFail(e.GetError(), e.GetReason());
-        postLIFO(evt);
+        postCtrl(evt);
     }
 }
 
@@ -32,6 +32,9 @@
 
 #include "qpcpp.h"
 #include "fw_pipe.h"
+#include "fw_trans.h"
+#include "fw_qstats.h"
+#include "fw_rtcbudget.h"
 #include "hsm_id.h"
 #include "event.h"
 
@@ -44,7 +47,10 @@ class System : public QActive {
 public:
     System();
     void Start(uint8_t prio) {
+        setCtrlQueue(m_ctrlQueueStor, ARRAY_COUNT(m_ctrlQueueStor));
         QActive::start(prio, m_evtQueueStor, ARRAY_COUNT(m_evtQueueStor), NULL, 0);
+        QueueStats::Register(this, m_name);
+        RtcBudget::Set(prio, RTC_BUDGET_US);
     }
 
 protected:
@@ -57,21 +63,76 @@ protected:
         static QState Stopping2(System * const me, QEvt const * const e);
         static QState Started(System * const me, QEvt const * const e); 
 
-    void HandleCfm(ErrorEvt const &e, uint8_t expectedCnt);
+    void SendReq(Evt *req, QSignal cfmSig, uint8_t group, uint32_t timeoutMs);
+    void HandleCfm(ErrorEvt const &e, uint8_t waitGroup);
 
     enum {
         EVT_QUEUE_COUNT = 16,
-        DEFER_QUEUE_COUNT = 4
+        // An RTC step posts at most one control event (DONE or FAIL), which
+        // is dispatched before any other event. One spare.
+        CTRL_QUEUE_COUNT = 2,
+        DEFER_QUEUE_COUNT = 4,
+        // Longest RTC step expected (see fw_rtcbudget.h). Formatting logs
+        // and reports takes most of it.
+        RTC_BUDGET_US = 1000
     };
     QEvt const *m_evtQueueStor[EVT_QUEUE_COUNT];
+    QEvt const *m_ctrlQueueStor[CTRL_QUEUE_COUNT];
     QEvt const *m_deferQueueStor[DEFER_QUEUE_COUNT];
     QEQueue m_deferQueue;
     uint8_t m_id;
     char const * m_name;
     uint16_t m_nextSequence;
     uint16_t m_savedInSeq;
-    uint8_t m_cfmCount;
+
+    // Groups of outstanding requests in m_trans.
+    enum {
+        GROUP_UART = 1,     // UartAct
+        GROUP_IO,           // UserLed, UserBtn
+        TRANS_COUNT = 4
+    };
+    TransTable::Entry m_transStor[TRANS_COUNT];
+    TransTable m_trans;
     
+    enum {
+        // Events alive longer than this are reported as potential leaks.
+        LEAK_THRESHOLD_MS = 5000,
+        // Period of the leak report. A multiple of the test period, so that
+        // it expires on the same tick (see TEST_TIMER_SLACK_MS).
+        LEAK_REPORT_INTERVAL_MS = 30000,
+        // Period of queue stats (SYSTEM_QUEUE_STATS_IND).
+        STATS_INTERVAL_MS = 60000,
+        // Timer slack allowing the periodic timers to expire on the same
+        // tick (see QTimeEvt::armX()). The stats period is a multiple of the
+        // test period and both are armed together, so they share a window
+        // every STATS_INTERVAL_MS. A wider stats slack would pick a tick
+        // outside the window of the test timer.
+        TEST_TIMER_SLACK_MS = 100,
+        STATS_TIMER_SLACK_MS = TEST_TIMER_SLACK_MS,
+        // The reports and benchmarks on button press run one per timeout
+        // (see ReportStep). The log FIFO (2KB) drains in about 180ms at
+        // 115200 baud.
+        REPORT_INTERVAL_MS = 200,
+        // Export of the context switch trace (SchedTrace) in chunks small
+        // enough for the log FIFO, after the last report.
+        TRACE_EXPORT_DELAY_MS = 500,
+        TRACE_EXPORT_INTERVAL_MS = 100,
+        TRACE_EXPORT_COUNT = 16
+    };
+
+    // Reports on button press, in order.
+    enum ReportStep {
+        REPORT_EVT_TRACKER,
+        REPORT_EVT_LATENCY,
+        REPORT_ISR_STAT,
+        REPORT_QUEUE_STATS,
+        REPORT_BENCH_PUBLISH,
+        REPORT_BENCH_ACTIVATION,
+        REPORT_BENCH_TICK,
+        REPORT_MSGQ_TEST,
+        REPORT_MUTEX_TEST
+    };
+
     enum {
         UART_OUT_FIFO_ORDER = 11,
         UART_IN_FIFO_ORDER = 10
@@ -81,8 +142,14 @@ protected:
     Fifo m_uart2OutFifo;
     Fifo m_uart2InFifo;
 
-    QTimeEvt m_stateTimer;
+    QTimeEvt m_transTimer;
     QTimeEvt m_testTimer;
+    QTimeEvt m_statsTimer;
+    QTimeEvt m_traceTimer;
+    uint32_t m_traceIndex;      // Next SchedTrace record to export.
+    QTimeEvt m_reportTimer;
+    uint32_t m_reportStep;      // Next ReportStep to run.
+    QTimeEvt m_leakTimer;
 };
 
 } // namespace APP
@@ -30,6 +30,7 @@
 #include "hsm_id.h"
 #include "fw_log.h"
 #include "event.h"
+#include "isr_route.h"
 #include "UartAct.h"
 
 Q_DEFINE_THIS_FILE
@@ -47,14 +48,22 @@ UART_HandleTypeDef *UartAct::GetHal(uint8_t id) {
     return &m_hal;
 }
 
+// Every request times out in m_trans (UART_ACT_TRANS_TIMER) before the start
+// or stop of UartAct does.
+Q_ASSERT_COMPILE(static_cast<uint32_t>(UartActStartReq::TIMEOUT_MS) > UartInStartReq::TIMEOUT_MS);
+Q_ASSERT_COMPILE(static_cast<uint32_t>(UartActStartReq::TIMEOUT_MS) > UartOutStartReq::TIMEOUT_MS);
+Q_ASSERT_COMPILE(static_cast<uint32_t>(UartActStopReq::TIMEOUT_MS) > UartInStopReq::TIMEOUT_MS);
+Q_ASSERT_COMPILE(static_cast<uint32_t>(UartActStopReq::TIMEOUT_MS) > UartOutStopReq::TIMEOUT_MS);
+
 UartAct::UartAct(uint8_t id, char const *name, char const *inName, char const *outName,
                  USART_TypeDef *dev) :
     QActive((QStateHandler)&UartAct::InitialPseudoState),
-    m_id(id), m_name(name), m_nextSequence(0), m_savedInSeq(0), m_cfmCount(0),
+    m_id(id), m_name(name), m_nextSequence(0), m_savedInSeq(0),
+    m_trans(m_transStor, ARRAY_COUNT(m_transStor), m_transTimer),
     m_uartIn(UART2_IN, inName, this, m_hal),
     m_uartOut(UART2_OUT, outName, this, m_hal),
     m_outFifo(NULL), m_inFifo(NULL),
-    m_stateTimer(this, UART_ACT_STATE_TIMER) {
+    m_transTimer(this, UART_ACT_TRANS_TIMER) {
     Q_ASSERT(dev);
     memset(&m_hal, 0, sizeof(m_hal));
     m_hal.Instance = dev;
@@ -63,10 +72,11 @@ UartAct::UartAct(uint8_t id, char const *name, char const *inName, char const *o
 QState UartAct::InitialPseudoState(UartAct * const me, QEvt const * const e) {
     (void)e;
     me->m_deferQueue.init(me->m_deferQueueStor, ARRAY_COUNT(me->m_deferQueueStor));
+    QueueStats::Register(&me->m_deferQueue, me->m_name, me->getPrio(), QueueStats::TYPE_DEFER);
     
     me->subscribe(UART_ACT_START_REQ);
     me->subscribe(UART_ACT_STOP_REQ);
-    me->subscribe(UART_ACT_STATE_TIMER);
+    me->subscribe(UART_ACT_TRANS_TIMER);
     me->subscribe(UART_ACT_START);
     me->subscribe(UART_ACT_DONE);
     me->subscribe(UART_ACT_FAIL);
@@ -79,7 +89,9 @@ QState UartAct::InitialPseudoState(UartAct * const me, QEvt const * const e) {
     me->subscribe(UART_OUT_WRITE_REQ);
     me->subscribe(UART_OUT_ACTIVE_TIMER);
     me->subscribe(UART_OUT_DONE);
+#ifdef ISR_ROUTE_PUBLISH
     me->subscribe(UART_OUT_DMA_DONE);
+#endif
     me->subscribe(UART_OUT_CONTINUE);
     me->subscribe(UART_OUT_HW_FAIL);
     
@@ -88,8 +100,11 @@ QState UartAct::InitialPseudoState(UartAct * const me, QEvt const * const e) {
     me->subscribe(UART_IN_STOP_REQ);
     me->subscribe(UART_IN_STOP_CFM);
     me->subscribe(UART_IN_STATE_TIMER);
+    me->subscribe(UART_IN_BATCH_TIMER);
     me->subscribe(UART_IN_DONE);
+#ifdef ISR_ROUTE_PUBLISH
     me->subscribe(UART_IN_DATA_RDY);
+#endif
     
     return Q_TRAN(&UartAct::Root);
 }
@@ -128,6 +143,15 @@ QState UartAct::Root(UartAct * const me, QEvt const * const e) {
             status = Q_TRAN(&UartAct::Stopping);
             break;
         }
+        case UART_ACT_TRANS_TIMER: {
+            LOG_EVENT(e);
+            if (me->m_trans.HandleTimeout()) {
+                Evt *evt = new UartActFail(ERROR_TIMEOUT, 0);
+                me->postCtrl(evt);
+            }
+            status = Q_HANDLED();
+            break;
+        }
         
         case UART_OUT_START_REQ:
         case UART_OUT_STOP_REQ:
@@ -138,14 +162,17 @@ QState UartAct::Root(UartAct * const me, QEvt const * const e) {
         case UART_OUT_CONTINUE:
         case UART_OUT_HW_FAIL: {
             me->m_uartOut.dispatch(e);
+            status = Q_HANDLED();
             break;
-        };
+        }
         case UART_IN_START_REQ:
         case UART_IN_STOP_REQ:
         case UART_IN_STATE_TIMER:
+        case UART_IN_BATCH_TIMER:
         case UART_IN_DONE:
         case UART_IN_DATA_RDY: {
             me->m_uartIn.dispatch(e);
+            status = Q_HANDLED();
             break;
         }
         
@@ -195,7 +222,7 @@ QState UartAct::Stopped(UartAct * const me, QEvt const * const e) {
                 me->m_outFifo = req.GetOutFifo();
                 me->m_inFifo = req.GetInFifo();
                 Evt *evt = new Evt(UART_ACT_START);
-                me->postLIFO(evt);
+                me->postCtrl(evt);
             } else {
                 DEBUG("HAL_UART_Init failed(%d", halStatus);
                 Evt *evt = new UartActStartCfm(req.GetSeq(), ERROR_HAL);
@@ -222,46 +249,33 @@ QState UartAct::Starting(UartAct * const me, QEvt const * const e) {
     switch (e->sig) {
         case Q_ENTRY_SIG: {
             LOG_EVENT(e);
-            uint32_t timeout = UartActStartReq::TIMEOUT_MS;
-            Q_ASSERT(timeout > UartInStartReq::TIMEOUT_MS);
-            Q_ASSERT(timeout > UartOutStartReq::TIMEOUT_MS);
-            me->m_stateTimer.armX(timeout);
-            me->m_cfmCount = 0;
+            me->m_trans.Reset();
             
             Q_ASSERT(me->m_outFifo && me->m_inFifo);
             Evt *evt = new UartOutStartReq(me->m_nextSequence++, me->m_outFifo);
-            // TODO - Save sequence number for comparison.
-            QF::PUBLISH(evt, me);
+            me->SendReq(evt, UART_OUT_START_CFM, UartOutStartReq::TIMEOUT_MS);
             evt = new UartInStartReq(me->m_nextSequence++, me->m_inFifo);
-            // TODO - Save sequence number for comparison.
-            QF::PUBLISH(evt, me);
+            me->SendReq(evt, UART_IN_START_CFM, UartInStartReq::TIMEOUT_MS);
             status = Q_HANDLED();
             break;
         }
         case Q_EXIT_SIG: {
             LOG_EVENT(e);
-            me->m_stateTimer.disarm();
             status = Q_HANDLED();
             break;
         }
         case UART_OUT_START_CFM:
         case UART_IN_START_CFM: {
             LOG_EVENT(e);
-            me->HandleCfm(ERROR_EVT_CAST(*e), 2);
+            me->HandleCfm(ERROR_EVT_CAST(*e));
             status = Q_HANDLED();
             break;
         }
-        case UART_ACT_FAIL:
-        case UART_ACT_STATE_TIMER: {
+        case UART_ACT_FAIL: {
             LOG_EVENT(e);
-            Evt *evt;
-            if (e->sig == UART_ACT_FAIL) {
-                ErrorEvt const &fail = ERROR_EVT_CAST(*e);
-                evt = new UartActStartCfm(me->m_savedInSeq,
-                                         fail.GetError(), fail.GetReason());
-            } else {
-                evt = new UartActStartCfm(me->m_savedInSeq, ERROR_TIMEOUT);
-            }
+            ErrorEvt const &fail = ERROR_EVT_CAST(*e);
+            Evt *evt = new UartActStartCfm(me->m_savedInSeq,
+                                           fail.GetError(), fail.GetReason());
             QF::PUBLISH(evt, me);
             status = Q_TRAN(&UartAct::Stopping);
             break;
@@ -286,25 +300,20 @@ QState UartAct::Stopping(UartAct * const me, QEvt const * const e) {
     switch (e->sig) {
         case Q_ENTRY_SIG: {
             LOG_EVENT(e);
-            uint32_t timeout = UartActStopReq::TIMEOUT_MS;
-            Q_ASSERT(timeout > UartInStopReq::TIMEOUT_MS);
-            Q_ASSERT(timeout > UartOutStopReq::TIMEOUT_MS);
-            me->m_stateTimer.armX(timeout);
-            me->m_cfmCount = 0;
+            me->m_trans.Reset();
 
             Evt *evt = new UartInStopReq(me->m_nextSequence++);
-            QF::PUBLISH(evt, me);
+            me->SendReq(evt, UART_IN_STOP_CFM, UartInStopReq::TIMEOUT_MS);
             evt = new UartOutStopReq(me->m_nextSequence++);
-            QF::PUBLISH(evt, me);
+            me->SendReq(evt, UART_OUT_STOP_CFM, UartOutStopReq::TIMEOUT_MS);
             status = Q_HANDLED();
             break;
         }
         case Q_EXIT_SIG: {
             LOG_EVENT(e);
-            me->m_stateTimer.disarm();
             status = Q_HANDLED();
-            // recall event
-            me->recall(&me->m_deferQueue);
+            // recall all deferred events
+            me->recallAll(&me->m_deferQueue);
             break;
         }
         case UART_ACT_STOP_REQ: {
@@ -317,12 +326,11 @@ QState UartAct::Stopping(UartAct * const me, QEvt const * const e) {
         case UART_IN_STOP_CFM:
         case UART_OUT_STOP_CFM: {
             LOG_EVENT(e);
-            me->HandleCfm(ERROR_EVT_CAST(*e), 2);
+            me->HandleCfm(ERROR_EVT_CAST(*e));
             status = Q_HANDLED();
             break;
         }
-        case UART_ACT_FAIL:
-        case UART_ACT_STATE_TIMER: {
+        case UART_ACT_FAIL: {
             LOG_EVENT(e);
             Q_ASSERT(0);
             // Will not reach here.
@@ -421,16 +429,25 @@ QState UartAct::Failed(UartAct * const me, QEvt const * const e) {
     return status;
 }
 
-void UartAct::HandleCfm(ErrorEvt const &e, uint8_t expectedCnt) {
+void UartAct::SendReq(Evt *req, QSignal cfmSig, uint32_t timeoutMs) {
+    m_trans.Add(req->GetSeq(), cfmSig, 0, timeoutMs);
+    QF::PUBLISH(req, this);
+}
+
+// Post UART_ACT_DONE when all outstanding requests have been confirmed.
+void UartAct::HandleCfm(ErrorEvt const &e) {
+    if (!m_trans.Remove(e)) {
+        Log::Debug(m_name, __FUNCTION__, "Stale CFM %s(%d) seq=%d", GetEvtName(e.sig), e.sig, e.GetSeq());
+        return;
+    }
     if (e.GetError() == ERROR_SUCCESS) {
-        // TODO - Compare seqeuence number.
-        if(++m_cfmCount == expectedCnt) {
+        if (m_trans.IsEmpty()) {
             Evt *evt = new Evt(UART_ACT_DONE);
-            postLIFO(evt);
+            postCtrl(evt);
         }
     } else {
         Evt *evt = new UartActFail(e.GetError(), e.GetReason());
-        postLIFO(evt);
+        postCtrl(evt);
     }
 }
 
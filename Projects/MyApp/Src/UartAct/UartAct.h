@@ -35,6 +35,9 @@
 #include "qpcpp.h"
 #include "fw_evt.h"
 #include "fw_pipe.h"
+#include "fw_trans.h"
+#include "fw_qstats.h"
+#include "fw_rtcbudget.h"
 #include "UartIn.h"
 #include "UartOut.h"
 
@@ -48,7 +51,16 @@ public:
     UartAct(uint8_t id, char const *name, char const *inName, char const *outName,
             USART_TypeDef *dev);
     void Start(uint8_t prio) {
+        setCtrlQueue(m_ctrlQueueStor, ARRAY_COUNT(m_ctrlQueueStor));
+#ifdef QF_ISR_POST_LOCKFREE
+        // DMA and RX events are posted by ISRs (see isr_route.h).
+        setIsrInbox(m_isrInboxStor, ARRAY_COUNT(m_isrInboxStor));
+#endif
         QActive::start(prio, m_evtQueueStor, ARRAY_COUNT(m_evtQueueStor), NULL, 0);
+        QueueStats::Register(this, m_name);
+        RtcBudget::Set(prio, RTC_BUDGET_US);
+        // Self-posted events (e.g. UART_OUT_CONTINUE) and DMA/RX events come in bursts.
+        setBurst(BURST_COUNT);
     }
     static UART_HandleTypeDef *GetHal(uint8_t id);
     
@@ -62,20 +74,33 @@ protected:
             static QState Normal(UartAct * const me, QEvt const * const e);
             static QState Failed(UartAct * const me, QEvt const * const e);
            
-    void HandleCfm(ErrorEvt const &e, uint8_t expectedCnt);
+    void SendReq(Evt *req, QSignal cfmSig, uint32_t timeoutMs);
+    void HandleCfm(ErrorEvt const &e);
 
     enum {
         EVT_QUEUE_COUNT = 16,
-        DEFER_QUEUE_COUNT = 4
+        // UartOut and HandleCfm() may each post a control event in the same
+        // RTC step. Control events are dispatched before any other event, so
+        // they do not pile up beyond that. Twice that for margin.
+        CTRL_QUEUE_COUNT = 4,
+        ISR_INBOX_COUNT = 4,
+        DEFER_QUEUE_COUNT = 4,
+        TRANS_COUNT = 2,
+        BURST_COUNT = 4,
+        // Longest RTC step expected (see fw_rtcbudget.h).
+        RTC_BUDGET_US = 200
     };
     QEvt const *m_evtQueueStor[EVT_QUEUE_COUNT];
+    QEvt const *m_ctrlQueueStor[CTRL_QUEUE_COUNT];
+    QEvt const *m_isrInboxStor[ISR_INBOX_COUNT];
     QEvt const *m_deferQueueStor[DEFER_QUEUE_COUNT];
     QEQueue m_deferQueue;
     uint8_t m_id;
     char const * m_name;
     uint16_t m_nextSequence;
     uint16_t m_savedInSeq;
-    uint8_t m_cfmCount;
+    TransTable::Entry m_transStor[TRANS_COUNT];
+    TransTable m_trans;
     
     // TODO - Modify to support multiple instance. Interface with ISR.
     static UART_HandleTypeDef m_hal;
@@ -84,7 +109,7 @@ protected:
     Fifo *m_outFifo;
     Fifo *m_inFifo;
 
-    QTimeEvt m_stateTimer;
+    QTimeEvt m_transTimer;
 };
 
 } // namespace APP
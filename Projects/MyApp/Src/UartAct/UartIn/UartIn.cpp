@@ -31,6 +31,7 @@
 #include "fw_log.h"
 #include "UartIn.h"
 #include "event.h"
+#include "isr_route.h"
 
 //Q_DEFINE_THIS_FILE
 
@@ -39,7 +40,7 @@ namespace APP {
 void UartIn::RxCallback(uint8_t id) {
     static uint16_t counter = 0;
     Evt *evt = new Evt(UART_IN_DATA_RDY, counter++);
-    QF::PUBLISH(evt, 0);
+    IsrRoutePost(evt);
 }
 
 void UartIn::EnableRxInt() {
@@ -57,10 +58,18 @@ void UartIn::DisableRxInt() {
     QF_CRIT_EXIT(crit);
 }
 
+void UartIn::PublishBatch(Evt *evt) {
+    if (evt) {
+        QF::PUBLISH(evt, this);
+    }
+}
+
 UartIn::UartIn(uint8_t id, char const *name, QActive *owner, UART_HandleTypeDef &hal) :
     QHsm((QStateHandler)&UartIn::InitialPseudoState), m_id(id), m_name(name), 
     m_nextSequence(0), m_owner(owner),
-    m_hal(hal), m_stateTimer(owner, UART_IN_STATE_TIMER) {}
+    m_hal(hal), m_stateTimer(owner, UART_IN_STATE_TIMER),
+    m_batchTimer(owner, UART_IN_BATCH_TIMER),
+    m_batch(m_batchTimer, BATCH_WINDOW_MS, m_nextSequence) {}
 
 QState UartIn::InitialPseudoState(UartIn * const me, QEvt const * const e) {
     (void)e;
@@ -142,6 +151,7 @@ QState UartIn::Started(UartIn * const me, QEvt const * const e) {
     switch (e->sig) {
         case Q_ENTRY_SIG: {
             LOG_EVENT(e);
+            me->m_batch.Reset();
             me->EnableRxInt();
             status = Q_HANDLED();
             break;
@@ -149,6 +159,9 @@ QState UartIn::Started(UartIn * const me, QEvt const * const e) {
         case Q_EXIT_SIG: {
             LOG_EVENT(e);
             me->DisableRxInt();
+            // Deliver chars received so far.
+            me->PublishBatch(me->m_batch.Flush());
+            me->m_batch.Reset();
             status = Q_HANDLED();
             break;
         }
@@ -163,9 +176,14 @@ QState UartIn::Started(UartIn * const me, QEvt const * const e) {
         case UART_IN_DATA_RDY: {
             //LOG_EVENT(e);
             char ch = me->m_hal.Instance->DR & (uint8_t)0x00FFU; 
-            Evt *evt = new UartInCharInd(me->m_nextSequence++, ch);
-            QF::PUBLISH(evt, me);
+            me->PublishBatch(me->m_batch.Add(ch));
             me->EnableRxInt();
+            status = Q_HANDLED();
+            break;
+        }
+        case UART_IN_BATCH_TIMER: {
+            me->PublishBatch(me->m_batch.OnTimeout());
+            status = Q_HANDLED();
             break;
         }
         default: {
@@ -34,7 +34,9 @@
 #include "stm32f4xx_hal.h"
 #include "qpcpp.h"
 #include "fw_evt.h"
+#include "fw_batch.h"
 #include "hsm_id.h"
+#include "event.h"
 
 using namespace QP;
 using namespace FW;
@@ -58,6 +60,11 @@ protected:
 
     void EnableRxInt();
     void DisableRxInt();
+    void PublishBatch(Evt *evt);
+
+    enum {
+        BATCH_WINDOW_MS = 10    // Max latency added to a received char.
+    };
 
     uint8_t m_id;
     char const * m_name;
@@ -66,6 +73,8 @@ protected:
     
     UART_HandleTypeDef &m_hal;
     QTimeEvt m_stateTimer;
+    QTimeEvt m_batchTimer;
+    Batcher<UartInDataInd, char> m_batch;
 };
 
 } // namespace APP
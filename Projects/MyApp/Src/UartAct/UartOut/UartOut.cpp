@@ -30,9 +30,11 @@
 #include "hsm_id.h"
 #include "fw_log.h"
 #include "fw_evt.h"
+#include "fw_qstats.h"
 #include "UartAct.h"
 #include "UartOut.h"
 #include "event.h"
+#include "isr_route.h"
 
 /*
 #undef LOG_EVENT
@@ -48,7 +50,7 @@ namespace APP {
 void UartOut::DmaCompleteCallback(uint8_t id) {
     static uint16_t counter = 0;
     Evt *evt = new Evt(UART_OUT_DMA_DONE, counter++);
-    QF::PUBLISH(evt, 0);
+    IsrRoutePost(evt);
 }
 
 UartOut::UartOut(uint8_t id, char const *name, QActive *owner, UART_HandleTypeDef &hal) :
@@ -60,6 +62,7 @@ UartOut::UartOut(uint8_t id, char const *name, QActive *owner, UART_HandleTypeDe
 QState UartOut::InitialPseudoState(UartOut * const me, QEvt const * const e) {
     (void)e;
     me->m_deferQueue.init(me->m_deferQueueStor, ARRAY_COUNT(me->m_deferQueueStor));
+    QueueStats::Register(&me->m_deferQueue, me->m_name, me->m_owner->getPrio(), QueueStats::TYPE_DEFER);
     return Q_TRAN(&UartOut::Root);
 }
 
@@ -262,7 +265,7 @@ QState UartOut::Normal(UartOut * const me, QEvt const * const e) {
             Q_ASSERT((len > 0) && (len <= fifo.GetUsedCount()));
             // Only applicable to STM32F7.
             //SCB_CleanDCache_by_Addr((uint32_t *)(ROUND_DOWN_32(addr)), ROUND_UP_32(addr + len - ROUND_DOWN_32(addr)));
-            HAL_UART_Transmit_DMA(&me->m_hal, (uint8_t*)addr, len);
+            HAL_UART_Transmit_DMA(&me->m_hal, reinterpret_cast<uint8_t *>(static_cast<uintptr_t>(addr)), len);
             me->m_writeCount = len;
             status = Q_HANDLED();
             break;
@@ -286,12 +289,12 @@ QState UartOut::Normal(UartOut * const me, QEvt const * const e) {
             Evt *evt;
             if (me->m_fifo->GetUsedCount()) {
                 evt = new Evt(UART_OUT_CONTINUE);
-                me->m_owner->postLIFO(evt);
+                me->m_owner->postCtrl(evt);
             } else {
                 evt = new Evt(UART_OUT_EMPTY_IND, me->m_nextSequence++);
                 QF::PUBLISH(evt, me);
                 evt = new Evt(UART_OUT_DONE);
-                me->m_owner->postLIFO(evt);
+                me->m_owner->postCtrl(evt);
             }
             status = Q_HANDLED();
             break;
@@ -321,8 +324,8 @@ QState UartOut::StopWait(UartOut * const me, QEvt const * const e) {
         }
         case Q_EXIT_SIG: {
             //LOG_EVENT(e);
-            // recall event
-            me->m_owner->recall(&me->m_deferQueue);
+            // recall all deferred events
+            me->m_owner->recallAll(&me->m_deferQueue);
             status = Q_HANDLED();
             break;
         }
@@ -337,7 +340,7 @@ QState UartOut::StopWait(UartOut * const me, QEvt const * const e) {
             //LOG_EVENT(e);
             me->m_fifo->IncReadIndex(me->m_writeCount);
             Evt *evt = new Evt(UART_OUT_DONE);
-            me->m_owner->postLIFO(evt);
+            me->m_owner->postCtrl(evt);
             status = Q_HANDLED();
             break;
         }
@@ -31,6 +31,7 @@
 #include "fw_log.h"
 #include "UserBtn.h"
 #include "event.h"
+#include "isr_route.h"
 #include "bsp.h"
 
 //Q_DEFINE_THIS_FILE
@@ -67,14 +68,14 @@ void UserBtn::DisableGpioInt() {
 void UserBtn::GpioIntCallback(uint8_t id) {
     static uint16_t counter = 0; 
     Evt *evt = new Evt(USER_BTN_TRIG, counter++);
-    QF::PUBLISH(evt, 0);
+    IsrRoutePost(evt);
     DisableGpioInt();
 }
 
 UserBtn::UserBtn() :
     QActive((QStateHandler)&UserBtn::InitialPseudoState), 
     m_id(USER_BTN), m_name("USER_BTN"), m_nextSequence(0), 
-    m_stateTimer(this, USER_BTN_STATE_TIMER) {}
+    m_stateTimer(this, USER_BTN_STATE_TIMER), m_debounceTimer(this, USER_BTN_DEBOUNCE) {}
 
 QState UserBtn::InitialPseudoState(UserBtn * const me, QEvt const * const e) {
     (void)e;
@@ -82,7 +83,9 @@ QState UserBtn::InitialPseudoState(UserBtn * const me, QEvt const * const e) {
     me->subscribe(USER_BTN_START_REQ);
     me->subscribe(USER_BTN_STOP_REQ);
     me->subscribe(USER_BTN_STATE_TIMER);
+#ifdef ISR_ROUTE_PUBLISH
     me->subscribe(USER_BTN_TRIG);
+#endif
     me->subscribe(USER_BTN_UP);
     me->subscribe(USER_BTN_DOWN);
     
@@ -171,6 +174,7 @@ QState UserBtn::Started(UserBtn * const me, QEvt const * const e) {
         case Q_EXIT_SIG: {
             LOG_EVENT(e);
             DisableGpioInt();
+            me->m_debounceTimer.Stop();
             status = Q_HANDLED();
             break;
         }
@@ -178,6 +182,16 @@ QState UserBtn::Started(UserBtn * const me, QEvt const * const e) {
             status = Q_TRAN(&UserBtn::Up);
             break;
         }
+        case USER_BTN_TRIG: {
+            // The interrupt stays disabled until the pin is sampled upon
+            // USER_BTN_DEBOUNCE.
+            LOG_EVENT(e);
+            if (!me->m_debounceTimer.IsArmed()) {
+                me->m_debounceTimer.Start(DEBOUNCE_US);
+            }
+            status = Q_HANDLED();
+            break;
+        }
         case USER_BTN_STOP_REQ: {
             LOG_EVENT(e);
             Evt const &req = EVT_CAST(*e);
@@ -209,12 +223,12 @@ QState UserBtn::Up(UserBtn * const me, QEvt const * const e) {
             status = Q_HANDLED();
             break;
         }
-        case USER_BTN_TRIG: {
+        case USER_BTN_DEBOUNCE: {
             LOG_EVENT(e);
             EnableGpioInt();
             if (HAL_GPIO_ReadPin(GPIOC, GPIO_PIN_13) == GPIO_PIN_RESET) {
                 Evt *evt = new Evt(USER_BTN_DOWN, me->m_nextSequence++);
-                me->postLIFO(evt);
+                me->postCtrl(evt);
             }
             status = Q_HANDLED();
             break;
@@ -246,12 +260,12 @@ QState UserBtn::Down(UserBtn * const me, QEvt const * const e) {
             status = Q_HANDLED();
             break;
         }
-        case USER_BTN_TRIG: {
+        case USER_BTN_DEBOUNCE: {
             LOG_EVENT(e);
             EnableGpioInt();
             if (HAL_GPIO_ReadPin(GPIOC, GPIO_PIN_13) != GPIO_PIN_RESET) {
                 Evt *evt = new Evt(USER_BTN_UP, me->m_nextSequence++);
-                me->postLIFO(evt);
+                me->postCtrl(evt);
             }
             status = Q_HANDLED();
             break;
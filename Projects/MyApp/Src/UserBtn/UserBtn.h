@@ -32,6 +32,9 @@
 
 #include "qpcpp.h"
 #include "fw_evt.h"
+#include "fw_qstats.h"
+#include "fw_rtcbudget.h"
+#include "fw_hrtimer.h"
 #include "hsm_id.h"
 
 using namespace QP;
@@ -43,7 +46,14 @@ class UserBtn : public QActive {
 public:
     UserBtn();
     void Start(uint8_t prio) {
+        setCtrlQueue(m_ctrlQueueStor, ARRAY_COUNT(m_ctrlQueueStor));
+#ifdef QF_ISR_POST_LOCKFREE
+        // USER_BTN_TRIG is posted by the EXTI ISR (see isr_route.h).
+        setIsrInbox(m_isrInboxStor, ARRAY_COUNT(m_isrInboxStor));
+#endif
         QActive::start(prio, m_evtQueueStor, ARRAY_COUNT(m_evtQueueStor), NULL, 0);
+        QueueStats::Register(this, m_name);
+        RtcBudget::Set(prio, RTC_BUDGET_US);
     }
     static void GpioIntCallback(uint8_t id);
 
@@ -60,14 +70,26 @@ protected:
     static void DisableGpioInt();
     
     enum {
-        EVT_QUEUE_COUNT = 16
+        EVT_QUEUE_COUNT = 16,
+        // An RTC step posts at most one control event (DOWN or UP), which
+        // is dispatched before any other event. One spare.
+        CTRL_QUEUE_COUNT = 2,
+        ISR_INBOX_COUNT = 2,
+        // Time from an edge to sampling the pin, during which the interrupt
+        // is disabled.
+        DEBOUNCE_US = 500,
+        // Longest RTC step expected (see fw_rtcbudget.h).
+        RTC_BUDGET_US = 100
     };
     QEvt const *m_evtQueueStor[EVT_QUEUE_COUNT];
+    QEvt const *m_ctrlQueueStor[CTRL_QUEUE_COUNT];
+    QEvt const *m_isrInboxStor[ISR_INBOX_COUNT];
     uint8_t m_id;
     char const * m_name;
     uint16_t m_nextSequence;    
 
     QTimeEvt m_stateTimer;
+    HrTimer m_debounceTimer;
 };
 
 } // namespace APP
@@ -206,8 +206,8 @@ QState UserLed::Started(UserLed * const me, QEvt const * const e) {
         case Q_ENTRY_SIG: {
             LOG_EVENT(e);       
             BSP_LED_Init(LED2);
-            bool status = me->ConfigPwm();
-            Q_ASSERT(status);
+            bool result = me->ConfigPwm();
+            Q_ASSERT(result);
             status = Q_HANDLED();
             break;
         }
@@ -32,6 +32,8 @@
 
 #include "qpcpp.h"
 #include "fw_evt.h"
+#include "fw_qstats.h"
+#include "fw_rtcbudget.h"
 #include "hsm_id.h"
 #include "bsp.h"
 
@@ -45,6 +47,8 @@ public:
     UserLed();
     void Start(uint8_t prio) {
         QActive::start(prio, m_evtQueueStor, ARRAY_COUNT(m_evtQueueStor), NULL, 0);
+        QueueStats::Register(this, m_name);
+        RtcBudget::Set(prio, RTC_BUDGET_US);
     }
 
 protected:
@@ -56,7 +60,9 @@ protected:
     bool ConfigPwm();
         
     enum {
-        EVT_QUEUE_COUNT = 16
+        EVT_QUEUE_COUNT = 16,
+        // Longest RTC step expected (see fw_rtcbudget.h).
+        RTC_BUDGET_US = 100
     };
     QEvt const *m_evtQueueStor[EVT_QUEUE_COUNT];
     uint8_t m_id;
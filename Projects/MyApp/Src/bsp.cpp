@@ -44,12 +44,31 @@
 
 static UART_HandleTypeDef usart;
 
+#ifdef ENABLE_BSP_TICKER
+// Processes tick rate 0 driven by SysTick.
+static QP::QTicker ticker(0);
+// QXK requires an event queue for every AO. The ticker delivers its single
+// event directly so the ring buffer is never used.
+static QP::QEvt const *tickerQueueSto[1];
+// SysTick is already running from HAL_Init() in BspInit(), but QTicker::post_()
+// must not be called before the ticker has a priority and a queue.
+static bool volatile tickerStarted = false;
+#endif
+
 /* top of stack (highest address) defined in the linker script -------------*/
 extern int CSTACK$$Limit;
 
+static void BspCycleCntInit() {
+    // Enable trace block and start DWT cycle counter.
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
 void BspInit() {
     // STM32F7xx HAL library initialization
     HAL_Init();
+    BspCycleCntInit();
 
 #ifdef ENABLE_BSP_PRINT
     // USART2 (TX=PA2, RX=PA3) is used as the virtual COM port in ST-Link.
@@ -74,6 +93,32 @@ uint32_t GetSystemMs() {
     return HAL_GetTick() * BSP_MSEC_PER_TICK;
 }
 
+uint32_t GetCycleCnt() {
+    return DWT->CYCCNT;
+}
+
+uint32_t GetCyclePerUs() {
+    return SystemCoreClock / 1000000;
+}
+
+#ifdef ENABLE_BSP_TICKER
+// Must be called before other AOs are started, since they may arm time events
+// in their initial transitions.
+void BspTickerStart(uint8_t prio) {
+    ticker.start(prio, tickerQueueSto, Q_DIM(tickerQueueSto), NULL, 0);
+    tickerStarted = true;
+}
+
+// Called from SysTick_Handler(). Ticks posted while the ticker has not run yet
+// are counted and processed together. Ticks before BspTickerStart() are dropped,
+// as no time event can be armed then.
+void BspTickerPost() {
+    if (tickerStarted) {
+        ticker.POST(static_cast<QP::QEvt const *>(0), &ticker);
+    }
+}
+#endif
+
 // Override the one defined in stm32f7xx_hal.c.
 // Callback by HAL_Init() called from BspInit().
 // Initialize SysTick interrupt as required by some HAL functions.
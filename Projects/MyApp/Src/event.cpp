@@ -44,8 +44,16 @@ char const * const eventName[] = {
     "SYSTEM_START_CFM",
     "SYSTEM_STOP_REQ",
     "SYSTEM_STOP_CFM",
-    "SYSTEM_STATE_TIMER",
+    "SYSTEM_QUEUE_STATS_IND",
+    "SYSTEM_CPU_LOAD_IND",
+    "SYSTEM_TRANS_TIMER",
     "SYSTEM_TEST_TIMER",
+    "SYSTEM_STATS_TIMER",
+    "SYSTEM_TRACE_TIMER",
+    "SYSTEM_REPORT_TIMER",
+    "SYSTEM_LEAK_TIMER",
+    "SYSTEM_BENCH",
+    "SYSTEM_RTC_OVERRUN",
     "SYSTEM_DONE",
     "SYSTEM_FAIL",
     
@@ -54,7 +62,7 @@ char const * const eventName[] = {
     "UART_ACT_STOP_REQ",
     "UART_ACT_STOP_CFM",
     "UART_ACT_FAIL_IND",
-    "UART_ACT_STATE_TIMER",
+    "UART_ACT_TRANS_TIMER",
     "UART_ACT_START",
     "UART_ACT_DONE",
     "UART_ACT_FAIL",
@@ -77,9 +85,10 @@ char const * const eventName[] = {
     "UART_IN_START_CFM",
     "UART_IN_STOP_REQ",
     "UART_IN_STOP_CFM",
-    "UART_IN_CHAR_IND",
+    "UART_IN_DATA_IND",
     "UART_IN_FAIL_IND",
     "UART_IN_STATE_TIMER",
+    "UART_IN_BATCH_TIMER",
     "UART_IN_DONE",
     "UART_IN_DATA_RDY",
     
@@ -91,6 +100,7 @@ char const * const eventName[] = {
     "USER_BTN_DOWN_IND",
     "USER_BTN_STATE_TIMER",
     "USER_BTN_TRIG",
+    "USER_BTN_DEBOUNCE",
     "USER_BTN_UP",
     "USER_BTN_DOWN",
     
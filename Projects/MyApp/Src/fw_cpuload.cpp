@@ -0,0 +1,172 @@
+/*******************************************************************************
+ * Copyright (C) 2017 Gallium Studio LLC (Lawrence Lo). All rights reserved. 
+ * All rights reserved.
+ *
+ * This program is open source software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ******************************************************************************/
+
+#include "qpcpp.h"
+#include "bsp.h"
+#include "fw_macro.h"
+#include "fw_cpuload.h"
+#include "fw_rtcbudget.h"
+#include "fw_schedtrace.h"
+
+Q_DEFINE_THIS_FILE
+
+using namespace QP;
+
+namespace FW {
+
+uint64_t CpuLoad::m_cycles[SLOT_COUNT];
+uint32_t CpuLoad::m_maxRtc[SLOT_COUNT];
+uint32_t CpuLoad::m_rtcBegin[SLOT_COUNT];
+uint32_t CpuLoad::m_stamp = 0;
+uint32_t CpuLoad::m_beginMs = 0;
+uint8_t CpuLoad::m_curr = 0;
+uint8_t CpuLoad::m_isrNest = 0;
+
+// Must be called with interrupts disabled.
+void CpuLoad::Charge() {
+    uint32_t now = GetCycleCnt();
+    m_cycles[m_isrNest ? SLOT_ISR : m_curr] += now - m_stamp;
+    m_stamp = now;
+}
+
+void CpuLoad::OnContextSw(uint8_t prio) {
+    Q_ASSERT(prio <= QF_MAX_ACTIVE);
+    Charge();
+    m_curr = prio;
+}
+
+void CpuLoad::OnIsrEntry() {
+    Charge();
+    m_isrNest++;
+}
+
+void CpuLoad::OnIsrExit() {
+    Q_ASSERT(m_isrNest);
+    Charge();
+    m_isrNest--;
+}
+
+void CpuLoad::OnRtcBegin(uint8_t prio) {
+    QF_CRIT_STAT_TYPE crit;
+    QF_CRIT_ENTRY(crit);
+    Charge();
+    m_rtcBegin[prio] = static_cast<uint32_t>(m_cycles[prio]);
+    QF_CRIT_EXIT(crit);
+}
+
+uint32_t CpuLoad::OnRtcEnd(uint8_t prio) {
+    QF_CRIT_STAT_TYPE crit;
+    QF_CRIT_ENTRY(crit);
+    Charge();
+    uint32_t cycles = static_cast<uint32_t>(m_cycles[prio]) - m_rtcBegin[prio];
+    if (cycles > m_maxRtc[prio]) {
+        m_maxRtc[prio] = cycles;
+    }
+    QF_CRIT_EXIT(crit);
+    return cycles;
+}
+
+uint32_t CpuLoad::Snapshot(Entry *entry, uint32_t count) {
+    Q_ASSERT(entry);
+    uint64_t cycles[SLOT_COUNT];
+    uint32_t maxRtc[SLOT_COUNT];
+    QF_CRIT_STAT_TYPE crit;
+    QF_CRIT_ENTRY(crit);
+    Charge();
+    for (uint32_t i = 0; i < SLOT_COUNT; i++) {
+        cycles[i] = m_cycles[i];
+        maxRtc[i] = m_maxRtc[i];
+        // Keep the RTC steps in progress (including the caller's) measured
+        // correctly across the reset.
+        m_rtcBegin[i] -= static_cast<uint32_t>(m_cycles[i]);
+        m_cycles[i] = 0;
+        m_maxRtc[i] = 0;
+    }
+    uint32_t nowMs = GetSystemMs();
+    uint32_t intervalMs = nowMs - m_beginMs;
+    m_beginMs = nowMs;
+    QF_CRIT_EXIT(crit);
+
+    uint32_t cyclePerUs = GetCyclePerUs();
+    uint64_t total = static_cast<uint64_t>(intervalMs) * cyclePerUs * 1000;
+    if (total == 0) {
+        return 0;
+    }
+    // ISRs and threads from high to low priority, idle last.
+    uint32_t n = 0;
+    uint32_t busy = 0;
+    for (uint32_t i = SLOT_ISR; (i > 0) && (n < count); i--) {
+        if (cycles[i]) {
+            Entry &e = entry[n++];
+            e.m_prio = static_cast<uint8_t>((i == SLOT_ISR) ? PRIO_ISR : i);
+            e.m_permille = static_cast<uint16_t>(LESS(cycles[i] * 1000 / total, 1000));
+            e.m_maxRtcUs = maxRtc[i] / cyclePerUs;
+            busy += e.m_permille;
+        }
+    }
+    if (n < count) {
+        Entry &e = entry[n++];
+        e.m_prio = 0;
+        e.m_permille = static_cast<uint16_t>((busy < 1000) ? (1000 - busy) : 0);
+        e.m_maxRtcUs = 0;
+    }
+    return n;
+}
+
+} // namespace FW
+
+// QXK callbacks enabled by QXK_CPU_LOAD in qf_port.h.
+#ifdef QXK_CPU_LOAD
+namespace QP {
+
+void QXK::onContextSw(uint_fast8_t const prio, uint_fast8_t const cause) {
+    FW::CpuLoad::OnContextSw(static_cast<uint8_t>(prio));
+    FW::SchedTrace::OnContextSw(static_cast<uint8_t>(prio), static_cast<uint8_t>(cause));
+}
+
+void QXK::onIsrEntry(void) {
+    FW::CpuLoad::OnIsrEntry();
+}
+
+void QXK::onIsrExit(void) {
+    FW::CpuLoad::OnIsrExit();
+}
+
+void QXK::onRtcBegin(uint_fast8_t const prio, QEvt const * const e) {
+    FW::CpuLoad::OnRtcBegin(static_cast<uint8_t>(prio));
+    FW::RtcBudget::OnBegin(static_cast<uint8_t>(prio), e);
+}
+
+void QXK::onRtcEnd(uint_fast8_t const prio) {
+    uint32_t cycles = FW::CpuLoad::OnRtcEnd(static_cast<uint8_t>(prio));
+    FW::RtcBudget::OnEnd(static_cast<uint8_t>(prio), cycles);
+}
+
+} // namespace QP
+#endif // QXK_CPU_LOAD
@@ -0,0 +1,189 @@
+/*******************************************************************************
+ * Copyright (C) 2017 Gallium Studio LLC (Lawrence Lo). All rights reserved. 
+ * All rights reserved.
+ *
+ * This program is open source software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ******************************************************************************/
+
+#include "qpcpp.h"
+#ifndef FW_HRTIMER_HOST
+#include "stm32f4xx_hal.h"
+#endif
+#include "bsp.h"
+#include "fw_hrtimer.h"
+
+Q_DEFINE_THIS_FILE
+
+using namespace QP;
+
+namespace FW {
+
+HrTimer *HrTimer::m_head = NULL;
+#ifdef FW_HRTIMER_HOST
+uint32_t HrTimer::m_hostTimeUs = 0;
+#endif
+
+void HrTimer::Start(uint32_t us) {
+    Q_ASSERT((us > 0) && (us <= MAX_US));
+    QF_CRIT_STAT_TYPE crit;
+    QF_CRIT_ENTRY(crit);
+    Q_ASSERT(!m_armed);
+    m_deadline = GetTimeUs() + us;
+    m_armed = true;
+    // Insert after timers with the same deadline, so they expire in start order.
+    HrTimer **link = &m_head;
+    while (*link && IsDue((*link)->m_deadline, m_deadline)) {
+        link = &(*link)->m_next;
+    }
+    m_next = *link;
+    *link = this;
+    if (m_head == this) {
+        SetCompare();
+    }
+    QF_CRIT_EXIT(crit);
+}
+
+bool HrTimer::Stop() {
+    QF_CRIT_STAT_TYPE crit;
+    QF_CRIT_ENTRY(crit);
+    bool wasArmed = m_armed;
+    if (wasArmed) {
+        HrTimer **link = &m_head;
+        while (*link != this) {
+            Q_ASSERT(*link);
+            link = &(*link)->m_next;
+        }
+        *link = m_next;
+        m_next = NULL;
+        m_armed = false;
+        // The compare channel is left as is. If it was for this timer, the
+        // interrupt finds nothing due and reloads it for the new head.
+    }
+    QF_CRIT_EXIT(crit);
+    return wasArmed;
+}
+
+// Must be called within a critical section.
+void HrTimer::ExpireDue(uint32_t now) {
+    while (m_head && IsDue(m_head->m_deadline, now)) {
+        HrTimer *t = m_head;
+        m_head = t->m_next;
+        t->m_next = NULL;
+        t->m_armed = false;
+        t->m_owner->POST(t, 0);
+    }
+}
+
+#ifdef FW_HRTIMER_HOST
+
+void HrTimer::Init() {
+    m_head = NULL;
+    m_hostTimeUs = 0;
+}
+
+uint32_t HrTimer::GetTimeUs() {
+    return m_hostTimeUs;
+}
+
+void HrTimer::IsrHandler() {
+    QF_CRIT_STAT_TYPE crit;
+    QF_CRIT_ENTRY(crit);
+    ExpireDue(m_hostTimeUs);
+    QF_CRIT_EXIT(crit);
+}
+
+// Nothing to program, HostAdvance() checks the head directly.
+void HrTimer::SetCompare() {
+}
+
+void HrTimer::HostAdvance(uint32_t us) {
+    QF_CRIT_STAT_TYPE crit;
+    QF_CRIT_ENTRY(crit);
+    uint32_t target = m_hostTimeUs + us;
+    // Stop at each deadline, so that the time seen by owners is exact.
+    while (m_head && IsDue(m_head->m_deadline, target)) {
+        m_hostTimeUs = m_head->m_deadline;
+        ExpireDue(m_hostTimeUs);
+    }
+    m_hostTimeUs = target;
+    QF_CRIT_EXIT(crit);
+}
+
+#else // FW_HRTIMER_HOST
+
+// TIM5 is a 32-bit timer on APB1. Channel 1 is used in output compare
+// (frozen) mode, which only raises CC1IF without driving any pin.
+void HrTimer::Init() {
+    __HAL_RCC_TIM5_CLK_ENABLE();
+    // Timer clock is twice PCLK1 when APB1 is divided.
+    uint32_t clk = HAL_RCC_GetPCLK1Freq();
+    if ((RCC->CFGR & RCC_CFGR_PPRE1) != RCC_CFGR_PPRE1_DIV1) {
+        clk *= 2;
+    }
+    TIM5->CR1 = 0;
+    TIM5->PSC = clk / 1000000 - 1;
+    TIM5->ARR = 0xFFFFFFFF;
+    TIM5->CCMR1 = 0;
+    TIM5->CNT = 0;
+    TIM5->EGR = TIM_EGR_UG;     // Load PSC.
+    TIM5->SR = 0;
+    TIM5->DIER = 0;
+    TIM5->CR1 = TIM_CR1_CEN;
+    NVIC_SetPriority(TIM5_IRQn, TIM5_PRIO);
+    NVIC_EnableIRQ(TIM5_IRQn);
+}
+
+uint32_t HrTimer::GetTimeUs() {
+    return TIM5->CNT;
+}
+
+void HrTimer::IsrHandler() {
+    QF_CRIT_STAT_TYPE crit;
+    QF_CRIT_ENTRY(crit);
+    TIM5->SR = ~TIM_SR_CC1IF;
+    ExpireDue(GetTimeUs());
+    SetCompare();
+    QF_CRIT_EXIT(crit);
+}
+
+// Load the deadline of the head into the compare channel.
+// Must be called within a critical section.
+void HrTimer::SetCompare() {
+    if (m_head == NULL) {
+        TIM5->DIER &= ~TIM_DIER_CC1IE;
+        return;
+    }
+    TIM5->CCR1 = m_head->m_deadline;
+    TIM5->DIER |= TIM_DIER_CC1IE;
+    // If the deadline has passed (or is passing) the counter may never match
+    // it, so generate the compare event by software.
+    if (IsDue(m_head->m_deadline, GetTimeUs() + 1)) {
+        TIM5->EGR = TIM_EGR_CC1G;
+    }
+}
+
+#endif // FW_HRTIMER_HOST
+
+} // namespace FW
@@ -0,0 +1,152 @@
+/*******************************************************************************
+ * Copyright (C) 2017 Gallium Studio LLC (Lawrence Lo). All rights reserved. 
+ * All rights reserved.
+ *
+ * This program is open source software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ******************************************************************************/
+
+#include "qpcpp.h"
+#include "bsp.h"
+#include "event.h"
+#include "fw_macro.h"
+#include "fw_log.h"
+#include "fw_latency.h"
+
+Q_DEFINE_THIS_FILE
+
+using namespace QP;
+using namespace APP;
+
+namespace FW {
+
+// Find() relies on both.
+Q_ASSERT_COMPILE((EvtLatency::SLOT_COUNT & (EvtLatency::SLOT_COUNT - 1)) == 0);
+Q_ASSERT_COMPILE((EvtLatency::SLOT_ORDER > 0) && (EvtLatency::SLOT_ORDER < 32));
+
+EvtLatency::Slot EvtLatency::m_slot[SLOT_COUNT];
+uint32_t EvtLatency::m_overflowCount = 0;
+
+// Must be called within a critical section.
+EvtLatency::Slot *EvtLatency::Find(uint16_t key, bool alloc) {
+    Q_ASSERT(key);
+    // Slots are never freed (except by Reset), so linear probing stops at the
+    // first free slot.
+    uint32_t i = static_cast<uint32_t>(key * 2654435761U) >> (32 - SLOT_ORDER);
+    for (uint32_t n = 0; n < SLOT_COUNT; n++) {
+        Slot &slot = m_slot[i];
+        if (slot.m_key == key) {
+            return &slot;
+        }
+        if (slot.m_key == 0) {
+            if (!alloc) {
+                return NULL;
+            }
+            slot.m_key = key;
+            return &slot;
+        }
+        i = (i + 1) & (SLOT_COUNT - 1);
+    }
+    return NULL;
+}
+
+void EvtLatency::OnDispatch(uint8_t prio, QSignal sig, uint32_t cycles) {
+    uint32_t bucket = cycles ? QF_LOG2(cycles) : 0;
+    bucket = LESS(bucket, BUCKET_COUNT - 1);
+    QF_CRIT_STAT_TYPE crit;
+    QF_CRIT_ENTRY(crit);
+    Slot *slot = Find(GetKey(sig, prio), true);
+    if (slot == NULL) {
+        m_overflowCount++;
+    } else if (slot->m_hist[bucket] < 0xFFFF) {
+        slot->m_hist[bucket]++;
+    }
+    QF_CRIT_EXIT(crit);
+}
+
+uint32_t EvtLatency::GetHist(QSignal sig, uint8_t prio, uint16_t *hist) {
+    Q_ASSERT(hist);
+    uint32_t total = 0;
+    QF_CRIT_STAT_TYPE crit;
+    QF_CRIT_ENTRY(crit);
+    Slot *slot = Find(GetKey(sig, prio), false);
+    for (uint32_t b = 0; b < BUCKET_COUNT; b++) {
+        hist[b] = slot ? slot->m_hist[b] : 0;
+        total += hist[b];
+    }
+    QF_CRIT_EXIT(crit);
+    return total;
+}
+
+void EvtLatency::Report() {
+    uint32_t cyclePerUs = GetCyclePerUs();
+    for (uint32_t i = 0; i < SLOT_COUNT; i++) {
+        uint16_t hist[BUCKET_COUNT];
+        uint32_t total = 0;
+        QF_CRIT_STAT_TYPE crit;
+        QF_CRIT_ENTRY(crit);
+        uint16_t key = m_slot[i].m_key;
+        for (uint32_t b = 0; b < BUCKET_COUNT; b++) {
+            hist[b] = m_slot[i].m_hist[b];
+            total += hist[b];
+        }
+        QF_CRIT_EXIT(crit);
+        if (total == 0) {
+            continue;
+        }
+        uint32_t sig = key >> 6;
+        PRINT("EvtLatency: %s(%lu) prio=%u n=%lu\n\r", GetEvtName(sig), sig, key & 0x3F, total);
+        for (uint32_t b = 0; b < BUCKET_COUNT; b++) {
+            if (hist[b]) {
+                // Lower bound of bucket in us.
+                uint32_t lower = b ? (BIT_MASK_AT(b - 1) / cyclePerUs) : 0;
+                PRINT("  >=%luus%s: %u\n\r", lower, (b == (BUCKET_COUNT - 1)) ? "+" : "", hist[b]);
+            }
+        }
+    }
+    PRINT("EvtLatency: overflow=%lu\n\r", m_overflowCount);
+}
+
+void EvtLatency::Reset() {
+    QF_CRIT_STAT_TYPE crit;
+    QF_CRIT_ENTRY(crit);
+    memset(m_slot, 0, sizeof(m_slot));
+    m_overflowCount = 0;
+    QF_CRIT_EXIT(crit);
+}
+
+} // namespace FW
+
+namespace QP {
+
+// QF callback enabled by QF_EVT_LATENCY in qf_port.h.
+#ifdef QF_EVT_LATENCY
+void QF::onEvtDispatch(uint_fast8_t const prio, QEvt const * const e) {
+    if (hasEvtStamp(e)) {
+        FW::EvtLatency::OnDispatch(static_cast<uint8_t>(prio), e->sig, QF_EVT_STAMP() - getEvtStamp(e));
+    }
+}
+#endif // QF_EVT_LATENCY
+
+} // namespace QP
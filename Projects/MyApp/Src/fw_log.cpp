@@ -100,7 +100,7 @@ uint32_t Log::Print(char const *format, ...) {
 void Log::Event(char const *name, char const *func, QP::QEvt const *e) {
     Q_ASSERT(name && func && e);
     char buf[BUF_LEN];
-    uint32_t len = snprintf(buf, BUF_LEN, "[%lu] %s (%s): %s(%d)\n\r", GetSystemMs(), name, func, GetEvtName(e->sig), e->sig);
+    uint32_t len = snprintf(buf, BUF_LEN, "[%lu] %s (%s): %s(%d)\n\r", static_cast<unsigned long>(GetSystemMs()), name, func, GetEvtName(e->sig), e->sig);
     len = LESS(len, (BUF_LEN - 1));
     buf[len] = 0;
     Write(buf, len);
@@ -111,7 +111,7 @@ void Log::Debug(char const *name, char const *func, char const *format, ...) {
     // Reserve 2 bytes for newline.
     const uint32_t MAX_LEN = sizeof(buf) - 2;
     // Note there is no space after type name.
-    uint32_t len = snprintf(buf, MAX_LEN, "[%lu] %s (%s): ", GetSystemMs(), name, func);
+    uint32_t len = snprintf(buf, MAX_LEN, "[%lu] %s (%s): ", static_cast<unsigned long>(GetSystemMs()), name, func);
     len = LESS(len, (MAX_LEN - 1));
     if (len < (MAX_LEN - 1)) {
         va_list arg;
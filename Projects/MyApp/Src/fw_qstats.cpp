@@ -0,0 +1,129 @@
+/*******************************************************************************
+ * Copyright (C) 2017 Gallium Studio LLC (Lawrence Lo). All rights reserved. 
+ * All rights reserved.
+ *
+ * This program is open source software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ******************************************************************************/
+
+#include "qpcpp.h"
+#include "fw_macro.h"
+#include "fw_log.h"
+#include "fw_qstats.h"
+
+Q_DEFINE_THIS_FILE
+
+using namespace QP;
+
+namespace FW {
+
+QueueStats::Reg QueueStats::m_reg[MAX_QUEUE];
+uint32_t QueueStats::m_count = 0;
+
+void QueueStats::Register(QActive const *act, char const *owner) {
+    Q_ASSERT(act);
+    uint8_t prio = static_cast<uint8_t>(act->getPrio());
+    Register(&act->m_eQueue, owner, prio, TYPE_EVT);
+#ifdef QF_ACTIVE_CTRL_QUEUE
+    // An unused control queue has no free entry.
+    if (act->m_ctrlQueue.getNMin()) {
+        Register(&act->m_ctrlQueue, owner, prio, TYPE_CTRL);
+    }
+#endif
+}
+
+void QueueStats::Register(QEQueue const *queue, char const *owner, uint8_t prio, Type type) {
+    Q_ASSERT(queue && owner);
+    QF_CRIT_STAT_TYPE crit;
+    QF_CRIT_ENTRY(crit);
+    for (uint32_t i = 0; i < m_count; i++) {
+        if (m_reg[i].m_queue == queue) {
+            QF_CRIT_EXIT(crit);
+            return;
+        }
+    }
+    Q_ASSERT(m_count < MAX_QUEUE);
+    Reg &reg = m_reg[m_count++];
+    reg.m_queue = queue;
+    reg.m_owner = owner;
+    reg.m_prio = prio;
+    reg.m_type = static_cast<uint8_t>(type);
+    QF_CRIT_EXIT(crit);
+}
+
+// Must be called within a critical section.
+void QueueStats::Fill(uint32_t index, Entry &entry) {
+    Reg const &reg = m_reg[index];
+    entry.m_index = static_cast<uint8_t>(index);
+    entry.m_prio = reg.m_prio;
+    entry.m_type = reg.m_type;
+    entry.m_capacity = static_cast<uint16_t>(reg.m_queue->getCapacity());
+    entry.m_minFree = static_cast<uint16_t>(reg.m_queue->getNMin());
+#ifdef QF_EQUEUE_STATS
+    entry.m_rejectCount = static_cast<uint16_t>(LESS(reg.m_queue->getNReject(), 0xFFFFUL));
+    entry.m_postCount = reg.m_queue->getNPost();
+#else
+    entry.m_rejectCount = 0;
+    entry.m_postCount = 0;
+#endif
+}
+
+uint32_t QueueStats::Snapshot(Entry *entry, uint32_t count) {
+    Q_ASSERT(entry);
+    QF_CRIT_STAT_TYPE crit;
+    QF_CRIT_ENTRY(crit);
+    count = LESS(count, m_count);
+    for (uint32_t i = 0; i < count; i++) {
+        Fill(i, entry[i]);
+    }
+    QF_CRIT_EXIT(crit);
+    return count;
+}
+
+void QueueStats::Report() {
+    Entry entry[MAX_QUEUE];
+    uint32_t count = Snapshot(entry, ARRAY_COUNT(entry));
+    for (uint32_t i = 0; i < count; i++) {
+        Entry const &e = entry[i];
+        PRINT("QueueStats: %s(%u) %s used=%u/%u post=%lu reject=%u\n\r", GetOwner(e.m_index), e.m_prio,
+              GetTypeName(e.m_type), e.m_capacity - e.m_minFree, e.m_capacity, e.m_postCount,
+              e.m_rejectCount);
+    }
+}
+
+// Registered queues are never removed, so an index stays valid.
+char const *QueueStats::GetOwner(uint8_t index) {
+    return (index < m_count) ? m_reg[index].m_owner : "?";
+}
+
+char const *QueueStats::GetTypeName(uint8_t type) {
+    switch (type) {
+        case TYPE_EVT: return "evt";
+        case TYPE_CTRL: return "ctrl";
+        case TYPE_DEFER: return "defer";
+        default: return "?";
+    }
+}
+
+} // namespace FW
@@ -0,0 +1,126 @@
+/*******************************************************************************
+ * Copyright (C) 2017 Gallium Studio LLC (Lawrence Lo). All rights reserved. 
+ * All rights reserved.
+ *
+ * This program is open source software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ******************************************************************************/
+
+#include "qpcpp.h"
+#include "bsp.h"
+#include "fw_macro.h"
+#include "fw_rtcbudget.h"
+
+Q_DEFINE_THIS_FILE
+
+using namespace QP;
+
+namespace FW {
+
+RtcBudget::Slot RtcBudget::m_slot[QF_MAX_ACTIVE + 1];
+QActive *RtcBudget::m_reportAct = NULL;
+QEvt RtcBudget::m_reportEvt(0);
+bool RtcBudget::m_reportPending = false;
+
+void RtcBudget::Set(uint8_t prio, uint32_t budgetUs) {
+    Q_ASSERT((prio > 0) && (prio <= QF_MAX_ACTIVE));
+    QF_CRIT_STAT_TYPE crit;
+    QF_CRIT_ENTRY(crit);
+    m_slot[prio].m_budget = budgetUs * GetCyclePerUs();
+    QF_CRIT_EXIT(crit);
+}
+
+void RtcBudget::SetReport(QActive *act, QSignal sig) {
+    Q_ASSERT(act);
+    QF_CRIT_STAT_TYPE crit;
+    QF_CRIT_ENTRY(crit);
+    m_reportEvt.sig = sig;
+    m_reportAct = act;
+    QF_CRIT_EXIT(crit);
+}
+
+uint32_t RtcBudget::Snapshot(Entry *entry, uint32_t count) {
+    Q_ASSERT(entry);
+    uint32_t n = 0;
+    // A single critical section, so that an overrun recorded by OnEnd() is
+    // either in this snapshot or posts a new report.
+    QF_CRIT_STAT_TYPE crit;
+    QF_CRIT_ENTRY(crit);
+    for (uint32_t prio = QF_MAX_ACTIVE; (prio > 0) && (n < count); prio--) {
+        Slot &slot = m_slot[prio];
+        if (slot.m_count) {
+            Entry &e = entry[n++];
+            e.m_state = slot.m_overrunState;
+            e.m_sig = slot.m_overrunSig;
+            e.m_prio = static_cast<uint8_t>(prio);
+            e.m_count = slot.m_count;
+            e.m_maxUs = slot.m_max;         // In cycles until converted below.
+            e.m_budgetUs = slot.m_budget;
+            slot.m_count = 0;
+            slot.m_max = 0;
+        }
+    }
+    m_reportPending = false;
+    QF_CRIT_EXIT(crit);
+    uint32_t cyclePerUs = GetCyclePerUs();
+    for (uint32_t i = 0; i < n; i++) {
+        entry[i].m_maxUs /= cyclePerUs;
+        entry[i].m_budgetUs /= cyclePerUs;
+    }
+    return n;
+}
+
+// Only touches the slot of the running AO, which cannot be preempted by itself.
+void RtcBudget::OnBegin(uint8_t prio, QEvt const *e) {
+    Slot &slot = m_slot[prio];
+    slot.m_sig = e->sig;
+    slot.m_state = QF::active_[prio]->state();
+}
+
+void RtcBudget::OnEnd(uint8_t prio, uint32_t cycles) {
+    Slot &slot = m_slot[prio];
+    if ((slot.m_budget == 0) || (cycles <= slot.m_budget)) {
+        return;
+    }
+    QF_CRIT_STAT_TYPE crit;
+    QF_CRIT_ENTRY(crit);
+    slot.m_overrunSig = slot.m_sig;
+    slot.m_overrunState = slot.m_state;
+    if (slot.m_count < 0xFFFF) {
+        slot.m_count++;
+    }
+    if (cycles > slot.m_max) {
+        slot.m_max = cycles;
+    }
+    bool report = (m_reportAct != NULL) && !m_reportPending;
+    m_reportPending = true;
+    QF_CRIT_EXIT(crit);
+    // Drop the report rather than assert if the queue is full. The overrun is
+    // still recorded.
+    if (report && !m_reportAct->POST_X(&m_reportEvt, 1, m_reportAct)) {
+        m_reportPending = false;
+    }
+}
+
+} // namespace FW
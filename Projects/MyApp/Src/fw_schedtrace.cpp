@@ -0,0 +1,96 @@
+/*******************************************************************************
+ * Copyright (C) 2017 Gallium Studio LLC (Lawrence Lo). All rights reserved. 
+ * All rights reserved.
+ *
+ * This program is open source software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ******************************************************************************/
+
+#include "qpcpp.h"
+#include "bsp.h"
+#include "fw_macro.h"
+#include "fw_log.h"
+#include "fw_schedtrace.h"
+
+Q_DEFINE_THIS_FILE
+
+using namespace QP;
+
+namespace FW {
+
+SchedTrace::Rec SchedTrace::m_rec[REC_COUNT];
+uint32_t SchedTrace::m_head = 0;
+uint8_t SchedTrace::m_prev = 0;
+bool SchedTrace::m_frozen = false;
+
+void SchedTrace::Freeze() {
+    QF_CRIT_STAT_TYPE crit;
+    QF_CRIT_ENTRY(crit);
+    m_frozen = true;
+    QF_CRIT_EXIT(crit);
+}
+
+void SchedTrace::Unfreeze() {
+    QF_CRIT_STAT_TYPE crit;
+    QF_CRIT_ENTRY(crit);
+    m_frozen = false;
+    QF_CRIT_EXIT(crit);
+}
+
+uint32_t SchedTrace::Export(uint32_t index, uint32_t count) {
+    // One character per QP::QXK::SwCause.
+    static char const causeChar[] = { 'P', 'I', 'U', 'B', 'N', 'R' };
+    QF_CRIT_STAT_TYPE crit;
+    QF_CRIT_ENTRY(crit);
+    uint32_t head = m_head;
+    QF_CRIT_EXIT(crit);
+    uint32_t total = LESS(head, static_cast<uint32_t>(REC_COUNT));
+    if (index == 0) {
+        PRINT("SchedTrace: begin n=%lu hz=%lu\n\r", total, GetCyclePerUs() * 1000000);
+    }
+    for (; (index < total) && (count > 0); index++, count--) {
+        Rec const &rec = m_rec[(head - total + index) & (REC_COUNT - 1)];
+        char cause = (rec.m_cause < ARRAY_COUNT(causeChar)) ? causeChar[rec.m_cause] : '?';
+        PRINT("SchedTrace: %08lx %u %u %c\n\r", rec.m_stamp, rec.m_prev, rec.m_next, cause);
+    }
+    if (index < total) {
+        return index;
+    }
+    PRINT("SchedTrace: end\n\r");
+    return 0;
+}
+
+void SchedTrace::OnContextSw(uint8_t prio, uint8_t cause) {
+    if (!m_frozen) {
+        Rec &rec = m_rec[m_head & (REC_COUNT - 1)];
+        rec.m_stamp = GetCycleCnt();
+        rec.m_prev = m_prev;
+        rec.m_next = prio;
+        rec.m_cause = cause;
+        m_head++;
+    }
+    m_prev = prio;
+}
+
+} // namespace FW
@@ -0,0 +1,121 @@
+/*******************************************************************************
+ * Copyright (C) 2017 Gallium Studio LLC (Lawrence Lo). All rights reserved. 
+ * All rights reserved.
+ *
+ * This program is open source software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ******************************************************************************/
+
+#include "stm32f4xx.h"
+#include "qpcpp.h"
+#include "fw_macro.h"
+#include "fw_log.h"
+#include "fw_stack.h"
+
+Q_DEFINE_THIS_FILE
+
+using namespace QP;
+
+#ifndef FW_STACK_HOST
+// Bounds of the main stack defined in the linker script.
+extern int CSTACK$$Base;
+extern int CSTACK$$Limit;
+#endif
+
+namespace FW {
+
+// Same as the pattern QXK_stackInit_() fills extended thread stacks with.
+static uint32_t const STACK_PAINT = 0xDEADBEEF;
+
+StackStats::Reg StackStats::m_reg[MAX_THREAD];
+uint32_t StackStats::m_count = 0;
+
+#ifdef FW_STACK_HOST
+
+// The main stack belongs to the host process and is not measured.
+void StackStats::PaintMain() {
+}
+
+uint32_t StackStats::GetMainSize() {
+    return 0;
+}
+
+uint32_t StackStats::GetMainUsed() {
+    return 0;
+}
+
+#else // FW_STACK_HOST
+
+void StackStats::PaintMain() {
+    uint32_t *p = reinterpret_cast<uint32_t *>(&CSTACK$$Base);
+    uint32_t *end = reinterpret_cast<uint32_t *>(__get_MSP()) - PAINT_MARGIN;
+    while (p < end) {
+        *p++ = STACK_PAINT;
+    }
+}
+
+uint32_t StackStats::GetMainSize() {
+    return static_cast<uint32_t>(reinterpret_cast<uint8_t *>(&CSTACK$$Limit) -
+                                 reinterpret_cast<uint8_t *>(&CSTACK$$Base));
+}
+
+uint32_t StackStats::GetMainUsed() {
+    uint32_t const *p = reinterpret_cast<uint32_t const *>(&CSTACK$$Base);
+    uint32_t const *limit = reinterpret_cast<uint32_t const *>(&CSTACK$$Limit);
+    while ((p < limit) && (*p == STACK_PAINT)) {
+        p++;
+    }
+    return static_cast<uint32_t>(limit - p) * sizeof(uint32_t);
+}
+
+#endif // FW_STACK_HOST
+
+void StackStats::Register(QXThread const *thread, char const *name) {
+    Q_ASSERT(thread && name);
+    QF_CRIT_STAT_TYPE crit;
+    QF_CRIT_ENTRY(crit);
+    for (uint32_t i = 0; i < m_count; i++) {
+        if (m_reg[i].m_thread == thread) {
+            QF_CRIT_EXIT(crit);
+            return;
+        }
+    }
+    Q_ASSERT(m_count < MAX_THREAD);
+    Reg &reg = m_reg[m_count++];
+    reg.m_thread = thread;
+    reg.m_name = name;
+    QF_CRIT_EXIT(crit);
+}
+
+void StackStats::Report() {
+    PRINT("StackStats: main used=%lu/%lu\n\r", GetMainUsed(), GetMainSize());
+    for (uint32_t i = 0; i < m_count; i++) {
+        Reg const &reg = m_reg[i];
+        PRINT("StackStats: %s(%u) used=%u/%u\n\r", reg.m_name, static_cast<unsigned>(reg.m_thread->getPrio()),
+              static_cast<unsigned>(reg.m_thread->getStackUsed()),
+              static_cast<unsigned>(reg.m_thread->getStackSize()));
+    }
+}
+
+} // namespace FW
@@ -0,0 +1,202 @@
+/*******************************************************************************
+ * Copyright (C) 2017 Gallium Studio LLC (Lawrence Lo). All rights reserved. 
+ * All rights reserved.
+ *
+ * This program is open source software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ******************************************************************************/
+
+#include "qpcpp.h"
+#include "bsp.h"
+#include "event.h"
+#include "fw_log.h"
+#include "fw_tracker.h"
+
+Q_DEFINE_THIS_FILE
+
+using namespace QP;
+using namespace APP;
+
+namespace FW {
+
+// Hash() and the probing mask rely on both.
+Q_ASSERT_COMPILE((EvtTracker::SLOT_COUNT & (EvtTracker::SLOT_COUNT - 1)) == 0);
+Q_ASSERT_COMPILE((EvtTracker::SLOT_ORDER > 0) && (EvtTracker::SLOT_ORDER < 32));
+
+EvtTracker::Slot EvtTracker::m_slot[SLOT_COUNT];
+uint16_t EvtTracker::m_hist[MAX_PUB_SIG][BUCKET_COUNT];
+uint32_t EvtTracker::m_liveCount = 0;
+uint32_t EvtTracker::m_maxLiveCount = 0;
+uint32_t EvtTracker::m_overflowCount = 0;
+
+uint32_t EvtTracker::Hash(QEvt const *e) {
+    // Pool blocks are at least 4-byte aligned. Fibonacci hashing spreads
+    // consecutive blocks across the table. The top SLOT_ORDER bits index it.
+    return (static_cast<uint32_t>(reinterpret_cast<uintptr_t>(e) >> 2) * 2654435761U) >> (32 - SLOT_ORDER);
+}
+
+uint8_t EvtTracker::GetSite() {
+#ifdef FW_TRACKER_HOST
+    // There is no exception number on the host.
+    if (QXK_ISR_CONTEXT_()) {
+        return SITE_ISR;
+    }
+#else
+    uint32_t ipsr = __get_IPSR();
+    if (ipsr) {
+        return SITE_ISR | (ipsr & SITE_MASK);
+    }
+#endif
+    return QXK_attr_.actPrio & SITE_MASK;
+}
+
+void EvtTracker::OnNew(QEvt const *e) {
+    uint32_t ms = GetSystemMs();
+    uint32_t cycle = GetCycleCnt();
+    uint8_t site = GetSite();
+    QF_CRIT_STAT_TYPE crit;
+    QF_CRIT_ENTRY(crit);
+    if (m_liveCount >= (SLOT_COUNT - 1)) {
+        // Always keep one empty slot to terminate probing.
+        m_overflowCount++;
+    } else {
+        uint32_t i = Hash(e);
+        while (m_slot[i].m_evt) {
+            i = (i + 1) & (SLOT_COUNT - 1);
+        }
+        m_slot[i].m_evt = e;
+        m_slot[i].m_ms = ms;
+        m_slot[i].m_cycle = cycle;
+        m_slot[i].m_site = site;
+        if (++m_liveCount > m_maxLiveCount) {
+            m_maxLiveCount = m_liveCount;
+        }
+    }
+    QF_CRIT_EXIT(crit);
+}
+
+void EvtTracker::OnGc(QEvt const *e) {
+    uint32_t cycle = GetCycleCnt();
+    QF_CRIT_STAT_TYPE crit;
+    QF_CRIT_ENTRY(crit);
+    uint32_t i = Hash(e);
+    while (m_slot[i].m_evt && (m_slot[i].m_evt != e)) {
+        i = (i + 1) & (SLOT_COUNT - 1);
+    }
+    // Not found if the event was allocated when the table had overflowed.
+    if (m_slot[i].m_evt) {
+        if (e->sig < MAX_PUB_SIG) {
+            uint32_t latency = cycle - m_slot[i].m_cycle;
+            uint32_t bucket = latency ? QF_LOG2(latency) : 0;
+            bucket = LESS(bucket, BUCKET_COUNT - 1);
+            if (m_hist[e->sig][bucket] < 0xFFFF) {
+                m_hist[e->sig][bucket]++;
+            }
+        }
+        // Backward-shift deletion to keep probe sequences intact without tombstones.
+        uint32_t j = i;
+        for (;;) {
+            m_slot[i].m_evt = NULL;
+            uint32_t home;
+            do {
+                j = (j + 1) & (SLOT_COUNT - 1);
+                if (m_slot[j].m_evt == NULL) {
+                    m_liveCount--;
+                    QF_CRIT_EXIT(crit);
+                    return;
+                }
+                home = Hash(m_slot[j].m_evt);
+                // Stay if home lies cyclically within (i, j].
+            } while ((i <= j) ? ((i < home) && (home <= j)) : ((i < home) || (home <= j)));
+            m_slot[i] = m_slot[j];
+            i = j;
+        }
+    }
+    QF_CRIT_EXIT(crit);
+}
+
+uint32_t EvtTracker::ReportLeak(uint32_t thresholdMs) {
+    uint32_t now = GetSystemMs();
+    uint32_t count = 0;
+    for (uint32_t i = 0; i < SLOT_COUNT; i++) {
+        QF_CRIT_STAT_TYPE crit;
+        QF_CRIT_ENTRY(crit);
+        Slot slot = m_slot[i];
+        QSignal sig = slot.m_evt ? slot.m_evt->sig : 0;
+        QF_CRIT_EXIT(crit);
+        if (slot.m_evt && ((now - slot.m_ms) >= thresholdMs)) {
+            PRINT("[%lu] EvtTracker: %p %s(%d) age=%lums site=%s%d\n\r", now,
+                  slot.m_evt, GetEvtName(sig), sig,
+                  now - slot.m_ms, (slot.m_site & SITE_ISR) ? "isr" : "prio",
+                  slot.m_site & SITE_MASK);
+            count++;
+        }
+    }
+    PRINT("[%lu] EvtTracker: leak=%lu live=%lu max=%lu overflow=%lu\n\r", now,
+          count, m_liveCount, m_maxLiveCount, m_overflowCount);
+    return count;
+}
+
+void EvtTracker::ReportLatency() {
+    uint32_t cyclePerUs = GetCyclePerUs();
+    for (uint32_t sig = 0; sig < MAX_PUB_SIG; sig++) {
+        uint16_t hist[BUCKET_COUNT];
+        uint32_t total = 0;
+        QF_CRIT_STAT_TYPE crit;
+        QF_CRIT_ENTRY(crit);
+        for (uint32_t b = 0; b < BUCKET_COUNT; b++) {
+            hist[b] = m_hist[sig][b];
+            total += hist[b];
+        }
+        QF_CRIT_EXIT(crit);
+        if (total == 0) {
+            continue;
+        }
+        PRINT("EvtTracker: %s(%lu) n=%lu\n\r", GetEvtName(sig), sig, total);
+        for (uint32_t b = 0; b < BUCKET_COUNT; b++) {
+            if (hist[b]) {
+                // Lower bound of bucket in us.
+                uint32_t lower = b ? (BIT_MASK_AT(b - 1) / cyclePerUs) : 0;
+                PRINT("  >=%luus%s: %u\n\r", lower, (b == (BUCKET_COUNT - 1)) ? "+" : "", hist[b]);
+            }
+        }
+    }
+}
+
+} // namespace FW
+
+namespace QP {
+
+// QF callbacks enabled by QF_EVT_TRACKER in qf_port.h.
+#ifdef QF_EVT_TRACKER
+void QF::onEvtNew(QEvt const * const e) {
+    FW::EvtTracker::OnNew(e);
+}
+
+void QF::onEvtGc(QEvt const * const e) {
+    FW::EvtTracker::OnGc(e);
+}
+#endif // QF_EVT_TRACKER
+
+} // namespace QP
@@ -0,0 +1,140 @@
+/*******************************************************************************
+ * Copyright (C) 2017 Gallium Studio LLC (Lawrence Lo). All rights reserved. 
+ * All rights reserved.
+ *
+ * This program is open source software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ******************************************************************************/
+
+#include "qpcpp.h"
+#include "bsp.h"
+#include "fw_macro.h"
+#include "fw_trans.h"
+
+Q_DEFINE_THIS_FILE
+
+using namespace QP;
+
+namespace FW {
+
+TransTable::TransTable(Entry stor[], uint8_t count, QTimeEvt &timer) :
+    m_stor(stor), m_count(count), m_used(0), m_timer(timer) {
+    Q_ASSERT(stor && (count > 0));
+    memset(m_stor, 0, sizeof(Entry) * count);
+}
+
+void TransTable::Reset() {
+    for (uint32_t i = 0; i < m_count; i++) {
+        m_stor[i].m_cfmSig = 0;
+    }
+    m_used = 0;
+    m_timer.disarm();
+}
+
+void TransTable::Add(uint16_t seq, QSignal cfmSig, uint8_t group, uint32_t timeoutMs) {
+    Q_ASSERT(cfmSig && timeoutMs);
+    uint32_t i;
+    for (i = 0; i < m_count; i++) {
+        if (m_stor[i].m_cfmSig == 0) {
+            break;
+        }
+    }
+    Q_ASSERT(i < m_count);
+    Entry &entry = m_stor[i];
+    entry.m_deadline = GetSystemMs() + timeoutMs;
+    entry.m_seq = seq;
+    entry.m_cfmSig = cfmSig;
+    entry.m_group = group;
+    m_used++;
+    ArmTimer();
+}
+
+bool TransTable::Remove(ErrorEvt const &cfm, uint8_t *group) {
+    for (uint32_t i = 0; i < m_count; i++) {
+        Entry &entry = m_stor[i];
+        if ((entry.m_cfmSig == cfm.sig) && (entry.m_seq == cfm.GetSeq())) {
+            if (group) {
+                *group = entry.m_group;
+            }
+            Free(entry);
+            ArmTimer();
+            return true;
+        }
+    }
+    return false;
+}
+
+uint32_t TransTable::HandleTimeout(uint8_t *group) {
+    uint32_t now = GetSystemMs();
+    uint32_t expired = 0;
+    for (uint32_t i = 0; i < m_count; i++) {
+        Entry &entry = m_stor[i];
+        // Signed difference handles wrap-around of ms counter.
+        if (entry.m_cfmSig && (static_cast<int32_t>(now - entry.m_deadline) >= 0)) {
+            if (group && (expired == 0)) {
+                *group = entry.m_group;
+            }
+            Free(entry);
+            expired++;
+        }
+    }
+    // A stale timeout (e.g. timer re-armed after it had been posted) expires nothing.
+    ArmTimer();
+    return expired;
+}
+
+bool TransTable::IsGroupDone(uint8_t group) const {
+    for (uint32_t i = 0; i < m_count; i++) {
+        if (m_stor[i].m_cfmSig && (m_stor[i].m_group == group)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void TransTable::ArmTimer() {
+    if (m_used == 0) {
+        m_timer.disarm();
+        return;
+    }
+    uint32_t now = GetSystemMs();
+    int32_t earliest = 0x7FFFFFFF;
+    for (uint32_t i = 0; i < m_count; i++) {
+        if (m_stor[i].m_cfmSig) {
+            int32_t remain = static_cast<int32_t>(m_stor[i].m_deadline - now);
+            earliest = LESS(earliest, remain);
+        }
+    }
+    // Already-passed deadlines are handled on the next tick.
+    uint32_t ticks = (earliest > 0) ? ROUND_UP_DIV(earliest, BSP_MSEC_PER_TICK) : 1;
+    m_timer.rearm(static_cast<QTimeEvtCtr>(ticks));
+}
+
+void TransTable::Free(Entry &entry) {
+    Q_ASSERT(m_used > 0);
+    entry.m_cfmSig = 0;
+    m_used--;
+}
+
+} // namespace FW
@@ -45,7 +45,12 @@
 #include "UserBtn.h"
 #include "UserLed.h"
 #include "event.h"
+#include "isr_route.h"
 #include "bsp.h"
+#include "fw_hrtimer.h"
+#include "fw_stack.h"
+#include "MutexTest.h"
+#include "MsgQueueTest.h"
 #include "qpcpp.h"
 
 //Q_DEFINE_THIS_FILE
@@ -67,12 +72,24 @@ enum {
     EVT_SIZE_LARGE = 256,
     EVT_COUNT_SMALL = 128,
     EVT_COUNT_MEDIUM = 16,
-    EVT_COUNT_LARGE = 4
+    EVT_COUNT_LARGE = 4,
+    // Total number of subscriptions of all AOs. The initial transitions
+    // make up to 57 (System 20, UartAct 25, UserBtn 6, UserLed 6, of which 3
+    // only with ISR_ROUTE_PUBLISH) and Bench adds 3 while it runs. The rest
+    // is headroom for new signals. Running out asserts in subscribe().
+    SUBSCR_COUNT = 64
 };
 uint32_t evtPoolSmall[ROUND_UP_DIV_4(EVT_SIZE_SMALL * EVT_COUNT_SMALL)];
 uint32_t evtPoolMedium[ROUND_UP_DIV_4(EVT_SIZE_MEDIUM * EVT_COUNT_MEDIUM)];
 uint32_t evtPoolLarge[ROUND_UP_DIV_4(EVT_SIZE_LARGE * EVT_COUNT_LARGE)];
+// The largest events (see event.h) must fit into the large pool.
+Q_ASSERT_COMPILE(sizeof(SystemQueueStatsInd) <= EVT_SIZE_LARGE);
+Q_ASSERT_COMPILE(sizeof(SystemCpuLoadInd) <= EVT_SIZE_LARGE);
+#ifdef QF_SUBSCR_COMPACT
+QP::QSubscr subscrSto[2 * SUBSCR_COUNT];   // Double-buffered, see QF::psInit().
+#else
 QP::QSubscrList subscrSto[MAX_PUB_SIG];
+#endif
 
 // Gallium - Test section placement.
 // Todo - Create a memory pool for DMA use, with cache disabled.
@@ -95,6 +112,9 @@ static void Error_Handler(void);
   */
 int main(void)
 {
+    // Paint the stack before it gets deep to measure its high-watermark.
+    StackStats::PaintMain();
+
     // Configure the system clock to 216 MHz.
     SystemClock_Config();
 
@@ -104,15 +124,33 @@ int main(void)
     QF::poolInit(evtPoolSmall, sizeof(evtPoolSmall), EVT_SIZE_SMALL);
     QF::poolInit(evtPoolMedium, sizeof(evtPoolMedium), EVT_SIZE_MEDIUM);
     QF::poolInit(evtPoolLarge, sizeof(evtPoolLarge), EVT_SIZE_LARGE);
+#ifdef QF_COALESCE_MAX_SIG
+    // Idempotent notifications ("something happened, go look"). A post is
+    // dropped if an instance is already queued to the same AO.
+    QF::setCoalesce(UART_IN_DATA_RDY);
+    QF::setCoalesce(UART_OUT_WRITE_REQ);
+    QF::setCoalesce(USER_BTN_TRIG);
+#endif
+#ifdef QF_SUBSCR_COMPACT
+    QP::QF::psInit(subscrSto, SUBSCR_COUNT, MAX_PUB_SIG); // init publish-subscribe
+#else
     QP::QF::psInit(subscrSto, Q_DIM(subscrSto)); // init publish-subscribe
+#endif
     // Initialize BSP include HAL.
     BspInit();    
+    FW::HrTimer::Init();
     
     // Start active objects.
+#ifdef ENABLE_BSP_TICKER
+    BspTickerStart(PRIO_TICKER);
+#endif
     uart2Act.Start(PRIO_UART2_ACT);
     userBtn.Start(PRIO_USER_BTN);
     userLed.Start(PRIO_USER_LED);
     sys.Start(PRIO_SYSTEM);
+    MutexTest::Start(PRIO_MUTEX_TEST);
+    MsgQueueTest::Start(PRIO_MSGQ_TEST);
+    IsrRouteCheck();
     Evt *evt = new SystemStartReq(0);
     QF::PUBLISH(evt, dummy);
     return QP::QF::run();
@@ -36,6 +36,9 @@
 #include "stm32f4xx_it.h"
 #include "qpcpp.h"
 #include "hsm_id.h"
+#include "bsp.h"
+#include "fw_log.h"
+#include "fw_hrtimer.h"
 #include "UartAct.h"
 #include "UserBtn.h"
 
@@ -44,6 +47,95 @@
 using namespace FW;
 using namespace APP;
 
+// Cycles spent in selected ISRs, including posting events and the QXK exit path.
+// Used to compare the cost of posting vs. publishing from ISRs (see isr_route.h).
+// Debug build only, like QF_CRIT_PROFILE, since IsrStatUpdate() adds a critical
+// section to every ISR it measures.
+#ifndef NDEBUG
+enum {
+    ISR_STAT_UART2_TX_DMA,
+    ISR_STAT_UART2_RX,
+    ISR_STAT_EXTI15_10,
+    ISR_STAT_TIM5,
+    ISR_STAT_SYSTICK,
+    ISR_STAT_COUNT
+};
+
+class IsrStat {
+public:
+    uint32_t m_count;
+    uint32_t m_total;       // Wraps around after long runs. Cleared upon report.
+    uint32_t m_max;
+};
+
+static IsrStat isrStat[ISR_STAT_COUNT];
+static char const * const isrStatName[ISR_STAT_COUNT] = {
+    "UART2_TX_DMA",
+    "UART2_RX",
+    "EXTI15_10",
+    "TIM5",
+    "SysTick"
+};
+
+#define ISR_STAT_BEGIN()        uint32_t isrStart_ = GetCycleCnt()
+#define ISR_STAT_END(i_)        IsrStatUpdate((i_), GetCycleCnt() - isrStart_)
+
+static void IsrStatUpdate(uint32_t index, uint32_t cycles) {
+    // Called with interrupts enabled. Lock out other kernel-aware ISRs.
+    QF_CRIT_STAT_TYPE crit;
+    QF_CRIT_ENTRY(crit);
+    IsrStat &stat = isrStat[index];
+    stat.m_count++;
+    stat.m_total += cycles;
+    if (cycles > stat.m_max) {
+        stat.m_max = cycles;
+    }
+    QF_CRIT_EXIT(crit);
+}
+#else
+#define ISR_STAT_BEGIN()        ((void)0)
+#define ISR_STAT_END(i_)        ((void)0)
+#endif // NDEBUG
+
+void IsrStatReport(void) {
+#ifndef NDEBUG
+    uint32_t cyclePerUs = GetCyclePerUs();
+    for (uint32_t i = 0; i < ISR_STAT_COUNT; i++) {
+        QF_CRIT_STAT_TYPE crit;
+        QF_CRIT_ENTRY(crit);
+        IsrStat stat = isrStat[i];
+        isrStat[i].m_count = 0;
+        isrStat[i].m_total = 0;
+        isrStat[i].m_max = 0;
+        QF_CRIT_EXIT(crit);
+        uint32_t avg = stat.m_count ? (stat.m_total / stat.m_count) : 0;
+        PRINT("IsrStat: %s n=%lu avg=%lucyc(%luus) max=%lucyc(%luus)\n\r", isrStatName[i], stat.m_count,
+              avg, avg / cyclePerUs, stat.m_max, stat.m_max / cyclePerUs);
+    }
+#endif
+#ifdef QF_CRIT_PROFILE
+    // Longest time interrupts were disabled by QF since the last report. ISR
+    // posts to AOs with an ISR inbox do not add to it (see QActive::setIsrInbox()).
+    QF_CRIT_STAT_TYPE crit;
+    QF_CRIT_ENTRY(crit);
+    uint32_t critMax = QF_critMax_;
+    QF_critMax_ = 0;
+    QF_CRIT_EXIT(crit);
+    PRINT("IsrStat: max QF critical section=%lucyc(%luus)\n\r", critMax, critMax / GetCyclePerUs());
+#endif
+#ifdef QF_TIMEEVT_WHEEL
+    // Ticks on which time events expired vs. the number of expirations since
+    // the last report. The closer they are, the less timer slack coalesced.
+    static uint32_t lastExpiryTicks = 0;
+    static uint32_t lastExpired = 0;
+    uint32_t expiryTicks = QP::QF::getExpiryTicksX(0);
+    uint32_t expired = QP::QF::getExpiredX(0);
+    PRINT("IsrStat: SysTick expiry ticks=%lu expired=%lu\n\r", expiryTicks - lastExpiryTicks, expired - lastExpired);
+    lastExpiryTicks = expiryTicks;
+    lastExpired = expired;
+#endif
+}
+
 /* USER CODE END 0 */
 
 /* External variables --------------------------------------------------------*/
@@ -57,14 +149,19 @@ using namespace APP;
 */
 void SysTick_Handler(void){
   /* USER CODE BEGIN SysTick_IRQn 0 */
-
+  ISR_STAT_BEGIN();
   /* USER CODE END SysTick_IRQn 0 */
   HAL_IncTick();
   HAL_SYSTICK_IRQHandler();
   /* USER CODE BEGIN SysTick_IRQn 1 */
   QXK_ISR_ENTRY();
+#ifdef ENABLE_BSP_TICKER
+  BspTickerPost();
+#else
   QP::QF::tickX_(0);
+#endif
   QXK_ISR_EXIT();
+  ISR_STAT_END(ISR_STAT_SYSTICK);
   /* USER CODE END SysTick_IRQn 1 */
 }
 
@@ -80,23 +177,26 @@ void SysTick_Handler(void){
 // UART2 TX DMA
 // Must be declared as extern "C" in header.
 void DMA1_Stream6_IRQHandler(void) {
+    ISR_STAT_BEGIN();
     QXK_ISR_ENTRY();
     UART_HandleTypeDef *hal = UartAct::GetHal(UART2_ACT);
     HAL_DMA_IRQHandler(hal->hdmatx);
     QXK_ISR_EXIT();
+    ISR_STAT_END(ISR_STAT_UART2_TX_DMA);
 }
 
 // UART2 RX
 // Must be declared as extern "C" in header.
 void USART2_IRQHandler(void)
 {
+    ISR_STAT_BEGIN();
     QXK_ISR_ENTRY();
     UART_HandleTypeDef *hal = UartAct::GetHal(UART2_ACT);
     volatile uint32_t isrflags   = READ_REG(hal->Instance->SR);
     if (isrflags & USART_SR_ORE) {
         // Over-run error. Read DR followed by SR to clear flag.
         // Note - ORE will trigger interrupt when RXNE interrupt is enabled.
-        uint32_t rxdata = READ_REG(hal->Instance->DR);
+        (void)READ_REG(hal->Instance->DR);
     } else {
         // Disable interrupt to avoid re-entering ISR before event is processed.
         CLEAR_BIT(hal->Instance->CR1, USART_CR1_RXNEIE);
@@ -105,17 +205,30 @@ void USART2_IRQHandler(void)
     // TX does not use it.
     //HAL_UART_IRQHandler(hal);
     QXK_ISR_EXIT();
+    ISR_STAT_END(ISR_STAT_UART2_RX);
 }
 
 // User Button (PC.13)
 void EXTI15_10_IRQHandler(void)
 {
+    ISR_STAT_BEGIN();
     QXK_ISR_ENTRY();
     if (__HAL_GPIO_EXTI_GET_IT(GPIO_PIN_13) != RESET) {
         HAL_GPIO_EXTI_IRQHandler(GPIO_PIN_13);
     }
     // Add other pins (10 to 15) here if needed.
     QXK_ISR_EXIT();  
+    ISR_STAT_END(ISR_STAT_EXTI15_10);
+}
+
+// HrTimer compare (see fw_hrtimer.h)
+void TIM5_IRQHandler(void)
+{
+    ISR_STAT_BEGIN();
+    QXK_ISR_ENTRY();
+    HrTimer::IsrHandler();
+    QXK_ISR_EXIT();
+    ISR_STAT_END(ISR_STAT_TIM5);
 }
 
 void HAL_GPIO_EXTI_Callback(uint16_t pin) {
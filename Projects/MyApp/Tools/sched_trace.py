@@ -0,0 +1,81 @@
+#!/usr/bin/env python3
+# Decode the QXK context switch trace exported by FW::SchedTrace in a captured
+# log. Prints a timeline of what ran at each priority and a preemption matrix
+# of switch counts from one priority (row) to another (column).
+#
+# Usage: sched_trace.py <log file>
+
+import re
+import sys
+
+CAUSE = {'P': 'post', 'I': 'isr', 'U': 'unlock', 'B': 'block',
+         'N': 'next', 'R': 'resume'}
+
+BEGIN = re.compile(r'SchedTrace: begin n=(\d+) hz=(\d+)')
+REC = re.compile(r'SchedTrace: ([0-9a-fA-F]{8}) (\d+) (\d+) (\S)')
+END = re.compile(r'SchedTrace: end')
+
+
+def parse(lines):
+    # Returns (hz, records) of the last complete export in the log.
+    result = None
+    hz, recs = None, None
+    for line in lines:
+        m = BEGIN.search(line)
+        if m:
+            hz, recs = int(m.group(2)), []
+            continue
+        if recs is None:
+            continue
+        m = REC.search(line)
+        if m:
+            recs.append((int(m.group(1), 16), int(m.group(2)),
+                         int(m.group(3)), m.group(4)))
+        elif END.search(line):
+            result = (hz, recs)
+            recs = None
+    return result
+
+
+def unwrap(recs):
+    # The cycle counter is 32-bit and wraps every ~51s at 84MHz.
+    stamps, base, last = [], 0, None
+    for rec in recs:
+        if last is not None and rec[0] < last:
+            base += 1 << 32
+        last = rec[0]
+        stamps.append(base + rec[0])
+    return stamps
+
+
+def main():
+    if len(sys.argv) != 2:
+        sys.exit('Usage: sched_trace.py <log file>')
+    with open(sys.argv[1], errors='replace') as f:
+        found = parse(f)
+    if not found or not found[1]:
+        sys.exit('No complete SchedTrace export found')
+    hz, recs = found
+    stamps = unwrap(recs)
+    us = lambda cycles: cycles * 1000000.0 / hz
+
+    print('Timeline (prio 0 is idle)')
+    print('%12s %10s %5s  %s' % ('start(us)', 'dur(us)', 'prio', 'cause'))
+    for i, (_, prev, nxt, cause) in enumerate(recs):
+        start = stamps[i] - stamps[0]
+        dur = '%10.1f' % us(stamps[i + 1] - stamps[i]) if i + 1 < len(recs) else '%10s' % '-'
+        print('%12.1f %s %5d  %s' % (us(start), dur, nxt, CAUSE.get(cause, cause)))
+
+    prios = sorted({r[1] for r in recs} | {r[2] for r in recs})
+    matrix = {}
+    for _, prev, nxt, _ in recs:
+        matrix[(prev, nxt)] = matrix.get((prev, nxt), 0) + 1
+    print()
+    print('Preemption matrix (row: from prio, column: to prio)')
+    print('%6s' % '' + ''.join('%6d' % p for p in prios))
+    for a in prios:
+        print('%6d' % a + ''.join('%6s' % (matrix.get((a, b)) or '.') for b in prios))
+
+
+if __name__ == '__main__':
+    main()
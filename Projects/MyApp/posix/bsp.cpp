@@ -0,0 +1,258 @@
+/*******************************************************************************
+ * Copyright (C) 2017 Gallium Studio LLC (Lawrence Lo). All rights reserved. 
+ * All rights reserved.
+ *
+ * This program is open source software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ******************************************************************************/
+
+// BSP of the host build (see Makefile). It provides the same interface as
+// ../Src/bsp.cpp on top of the POSIX port of QP. The ISRs of the target in
+// ../Src/stm32f4xx_it.cpp are raised by host threads:
+// - SysTick_Handler() and the HrTimer by the clock thread of the port.
+// - USART2_IRQHandler() and EXTI15_10_IRQHandler() by the console thread
+//   below. Every byte read from stdin is received by USART2, except Ctrl-B
+//   which presses the user button and releases it BTN_HOLD_MS later.
+// - DMA1_Stream6_IRQHandler() by the TX DMA thread in hal.cpp.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <termios.h>
+// Output delay flags of termios.h clash with register names (USART2->CR1).
+#undef CR1
+#undef CR2
+#undef CR3
+#include <pthread.h>
+#include "qpcpp.h"
+#include "stm32f4xx.h"
+#include "stm32f4xx_hal.h"
+#include "stm32f4xx_it.h"
+#include "fw_hrtimer.h"
+#include "bsp.h"
+
+Q_DEFINE_THIS_FILE
+
+using namespace FW;
+
+enum {
+    // Core clock of the target. The virtual cycle counter runs at this rate
+    // so that cycle counts read the same as on the board.
+    CORE_CLOCK_HZ = 84000000,
+    BTN_HOLD_MS = 100,
+    KEY_BTN = 0x02              // Ctrl-B
+};
+
+#ifdef ENABLE_BSP_TICKER
+// Processes tick rate 0 driven by SysTick.
+static QP::QTicker ticker(0);
+// QXK requires an event queue for every AO. The ticker delivers its single
+// event directly so the ring buffer is never used.
+static QP::QEvt const *tickerQueueSto[1];
+// SysTick is already running from HAL_Init() in BspInit(), but QTicker::post_()
+// must not be called before the ticker has a priority and a queue.
+static bool volatile tickerStarted = false;
+#endif
+
+static struct timespec startTime;
+static struct termios savedTermios;
+static bool termiosSaved = false;
+
+static void BspRestoreTerminal() {
+    if (termiosSaved) {
+        tcsetattr(STDIN_FILENO, TCSANOW, &savedTermios);
+    }
+}
+
+// Deliver keys to the application as they are typed. Ctrl-C still quits.
+static void BspRawTerminal() {
+    if (!isatty(STDIN_FILENO) || (tcgetattr(STDIN_FILENO, &savedTermios) != 0)) {
+        return;
+    }
+    termiosSaved = true;
+    atexit(BspRestoreTerminal);
+    struct termios raw = savedTermios;
+    raw.c_lflag &= ~(ICANON | ECHO);
+    raw.c_cc[VMIN] = 1;
+    raw.c_cc[VTIME] = 0;
+    tcsetattr(STDIN_FILENO, TCSANOW, &raw);
+}
+
+static void BspSleepMs(uint32_t ms) {
+    struct timespec t;
+    t.tv_sec = ms / 1000;
+    t.tv_nsec = (ms % 1000) * 1000000L;
+    nanosleep(&t, NULL);
+}
+
+// Set the level of the button pin (PC.13, low when pressed) and raise its
+// EXTI interrupt if unmasked.
+static void BspSetButton(bool pressed) {
+    QF_CRIT_STAT_TYPE crit;
+    QF_CRIT_ENTRY(crit);
+    if (pressed) {
+        GPIOC->IDR &= ~GPIO_PIN_13;
+    } else {
+        GPIOC->IDR |= GPIO_PIN_13;
+    }
+    bool raise = (EXTI->IMR & GPIO_PIN_13) != 0;
+    if (raise) {
+        EXTI->PR |= GPIO_PIN_13;
+    }
+    QF_CRIT_EXIT(crit);
+    if (raise) {
+        EXTI15_10_IRQHandler();
+    }
+}
+
+// Receive a byte on USART2. Like hardware flow control, it waits for UartIn to
+// re-enable the RXNE interrupt after reading the previous byte, so nothing is
+// lost to overrun.
+static void BspReceive(uint8_t ch) {
+    for (;;) {
+        QF_CRIT_STAT_TYPE crit;
+        QF_CRIT_ENTRY(crit);
+        bool ready = (USART2->CR1 & USART_CR1_RXNEIE) != 0;
+        if (ready) {
+            USART2->DR = ch;
+            USART2->SR = USART_SR_RXNE;
+        }
+        QF_CRIT_EXIT(crit);
+        if (ready) {
+            USART2_IRQHandler();
+            return;
+        }
+        BspSleepMs(1);
+    }
+}
+
+static void *BspConsoleThread(void *arg) {
+    (void)arg;
+    uint8_t ch;
+    while (read(STDIN_FILENO, &ch, 1) == 1) {
+        if (ch == KEY_BTN) {
+            BspSetButton(true);
+            BspSleepMs(BTN_HOLD_MS);
+            BspSetButton(false);
+        } else {
+            BspReceive(ch);
+        }
+    }
+    // Keep running at the end of input (e.g. a script piped into stdin).
+    return NULL;
+}
+
+void BspInit() {
+    clock_gettime(CLOCK_MONOTONIC, &startTime);
+    SystemCoreClock = CORE_CLOCK_HZ;
+    // Button released.
+    GPIOC->IDR |= GPIO_PIN_13;
+    BspRawTerminal();
+    char const *test = "BspInit success\n\r";
+    BspWrite(test, strlen(test));
+}
+
+void BspWrite(char const *buf, uint32_t len) {
+    fwrite(buf, 1, len, stdout);
+    fflush(stdout);
+}
+
+uint32_t GetSystemMs() {
+    return HAL_GetTick() * BSP_MSEC_PER_TICK;
+}
+
+uint32_t GetCycleCnt() {
+    return QF_getCycleCnt();
+}
+
+uint32_t GetCyclePerUs() {
+    return SystemCoreClock / 1000000;
+}
+
+#ifdef ENABLE_BSP_TICKER
+// Must be called before other AOs are started, since they may arm time events
+// in their initial transitions.
+void BspTickerStart(uint8_t prio) {
+    ticker.start(prio, tickerQueueSto, Q_DIM(tickerQueueSto), NULL, 0);
+    tickerStarted = true;
+}
+
+// Called from SysTick_Handler(). Ticks posted while the ticker has not run yet
+// are counted and processed together. Ticks before BspTickerStart() are dropped,
+// as no time event can be armed then.
+void BspTickerPost() {
+    if (tickerStarted) {
+        ticker.POST(static_cast<QP::QEvt const *>(0), &ticker);
+    }
+}
+#endif
+
+// Virtual DWT cycle counter (see qf_port.h), wrapping around like the real one.
+extern "C" uint32_t QF_getCycleCnt(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    uint64_t ns = static_cast<uint64_t>(now.tv_sec - startTime.tv_sec) * 1000000000U +
+                  now.tv_nsec - startTime.tv_nsec;
+    return static_cast<uint32_t>(ns * (CORE_CLOCK_HZ / 1000000) / 1000);
+}
+
+// Called from the clock thread of the port. It is the SysTick interrupt, and
+// advances the virtual clock of HrTimer in place of its TIM5 interrupt.
+extern "C" void QF_onClockTick(void) {
+    SysTick_Handler();
+    QXK_ISR_ENTRY();
+    HrTimer::HostAdvance(BSP_MSEC_PER_TICK * 1000);
+    QXK_ISR_EXIT();
+}
+
+// namespace QP **************************************************************
+namespace QP {
+
+// QF callbacks ==============================================================
+void QF::onStartup(void) {
+    QF_setTickRate(BSP_TICKS_PER_SEC);
+    pthread_t thread;
+    int err = pthread_create(&thread, NULL, &BspConsoleThread, NULL);
+    Q_ASSERT(err == 0);
+}
+//............................................................................
+void QF::onCleanup(void) {
+}
+//............................................................................
+void QXK::onIdle(void) {
+    // In place of WFI. Returns after activating what an ISR has made ready.
+    QXK_waitForIsr();
+}
+
+//............................................................................
+extern "C" void Q_onAssert(char const * const module, int loc) {
+    fflush(stdout);
+    fprintf(stderr, "\n\rAssertion failed in %s:%d\n\r", module, loc);
+    BspRestoreTerminal();
+    abort();
+}
+
+} // namespace QP
@@ -0,0 +1,282 @@
+/*******************************************************************************
+ * Copyright (C) 2017 Gallium Studio LLC (Lawrence Lo). All rights reserved. 
+ * All rights reserved.
+ *
+ * This program is open source software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ******************************************************************************/
+
+// HAL stubs of the host build (see Makefile). The peripheral and core
+// registers are plain host memory mapped at their addresses on the target, so
+// that register accesses in the application need no change. They neither
+// reset to the values of the datasheet nor have side effects, which the stubs
+// below and the simulated ISRs in bsp.cpp make up for where the application
+// depends on them.
+// USART2 transmits to stdout. A host thread stands in for its TX DMA and
+// raises DMA1_Stream6_IRQHandler() upon completion.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include "stm32f4xx_hal.h"
+#include "stm32f4xx_nucleo.h"
+#include "stm32f4xx_it.h"
+
+extern "C" {
+
+__IO uint32_t uwTick;
+
+// Regions covering the peripherals used (APB1/APB2/AHB1) and the Cortex-M
+// private peripheral bus (SysTick, NVIC, SCB, DWT, DBGMCU).
+static void MapRegion(uintptr_t base, size_t size) {
+    void *p = mmap(reinterpret_cast<void *>(base), size, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1, 0);
+    if (p != reinterpret_cast<void *>(base)) {
+        fprintf(stderr, "Cannot map registers at 0x%08lx\n", static_cast<unsigned long>(base));
+        exit(1);
+    }
+}
+
+// Runs before static constructors, which may already access registers.
+__attribute__((constructor(101))) static void MapRegisters() {
+    MapRegion(PERIPH_BASE, 0x00100000);
+    MapRegion(SCS_BASE & 0xFFF00000, 0x00100000);
+}
+
+static pthread_mutex_t dmaMutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t dmaCond = PTHREAD_COND_INITIALIZER;
+static UART_HandleTypeDef *dmaTxUart = NULL;
+
+static void *DmaTxThread(void *arg) {
+    (void)arg;
+    for (;;) {
+        pthread_mutex_lock(&dmaMutex);
+        while (dmaTxUart == NULL) {
+            pthread_cond_wait(&dmaCond, &dmaMutex);
+        }
+        UART_HandleTypeDef *huart = dmaTxUart;
+        pthread_mutex_unlock(&dmaMutex);
+        fwrite(huart->pTxBuffPtr, 1, huart->TxXferSize, stdout);
+        fflush(stdout);
+        pthread_mutex_lock(&dmaMutex);
+        dmaTxUart = NULL;
+        pthread_mutex_unlock(&dmaMutex);
+        DMA1_Stream6_IRQHandler();
+    }
+    return NULL;
+}
+
+static void DmaTxCplt(DMA_HandleTypeDef *hdma) {
+    UART_HandleTypeDef *huart = static_cast<UART_HandleTypeDef *>(hdma->Parent);
+    huart->gState = HAL_UART_STATE_READY;
+    HAL_UART_TxCpltCallback(huart);
+}
+
+HAL_StatusTypeDef HAL_Init(void) {
+    return HAL_OK;
+}
+
+void HAL_IncTick(void) {
+    uwTick++;
+}
+
+uint32_t HAL_GetTick(void) {
+    return uwTick;
+}
+
+void HAL_SYSTICK_IRQHandler(void) {
+}
+
+// The clock tree of the board is not simulated. BspInit() sets SystemCoreClock
+// to the core clock of the target instead.
+HAL_StatusTypeDef HAL_RCC_OscConfig(RCC_OscInitTypeDef *RCC_OscInitStruct) {
+    (void)RCC_OscInitStruct;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_RCC_ClockConfig(RCC_ClkInitTypeDef *RCC_ClkInitStruct, uint32_t FLatency) {
+    (void)RCC_ClkInitStruct;
+    (void)FLatency;
+    return HAL_OK;
+}
+
+uint32_t HAL_RCC_GetSysClockFreq(void) {
+    return SystemCoreClock;
+}
+
+uint32_t HAL_RCC_GetHCLKFreq(void) {
+    return SystemCoreClock;
+}
+
+uint32_t HAL_RCC_GetPCLK1Freq(void) {
+    return SystemCoreClock / 2;
+}
+
+uint32_t HAL_RCC_GetPCLK2Freq(void) {
+    return SystemCoreClock;
+}
+
+// Only the EXTI interrupt mask is simulated, as the EXTI lines are shared by
+// all ports. The interrupt mode bit is private to stm32f4xx_hal_gpio.c.
+enum {
+    GPIO_MODE_IT_BIT = 0x00010000U
+};
+
+void HAL_GPIO_Init(GPIO_TypeDef *GPIOx, GPIO_InitTypeDef *GPIO_Init) {
+    (void)GPIOx;
+    if (GPIO_Init->Mode & GPIO_MODE_IT_BIT) {
+        EXTI->IMR |= GPIO_Init->Pin;
+    } else {
+        EXTI->IMR &= ~GPIO_Init->Pin;
+    }
+}
+
+void HAL_GPIO_DeInit(GPIO_TypeDef *GPIOx, uint32_t GPIO_Pin) {
+    (void)GPIOx;
+    EXTI->IMR &= ~GPIO_Pin;
+}
+
+GPIO_PinState HAL_GPIO_ReadPin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin) {
+    return (GPIOx->IDR & GPIO_Pin) ? GPIO_PIN_SET : GPIO_PIN_RESET;
+}
+
+// The pending bit is write-one-to-clear on the target.
+void HAL_GPIO_EXTI_IRQHandler(uint16_t GPIO_Pin) {
+    if (EXTI->PR & GPIO_Pin) {
+        EXTI->PR &= ~static_cast<uint32_t>(GPIO_Pin);
+        HAL_GPIO_EXTI_Callback(GPIO_Pin);
+    }
+}
+
+HAL_StatusTypeDef HAL_DMA_Init(DMA_HandleTypeDef *hdma) {
+    hdma->State = HAL_DMA_STATE_READY;
+    return HAL_OK;
+}
+
+void HAL_DMA_IRQHandler(DMA_HandleTypeDef *hdma) {
+    if (hdma->XferCpltCallback) {
+        hdma->XferCpltCallback(hdma);
+    }
+}
+
+HAL_StatusTypeDef HAL_UART_Init(UART_HandleTypeDef *huart) {
+    if (huart->gState == HAL_UART_STATE_RESET) {
+        huart->Lock = HAL_UNLOCKED;
+        HAL_UART_MspInit(huart);
+    }
+    huart->gState = HAL_UART_STATE_READY;
+    huart->RxState = HAL_UART_STATE_READY;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_UART_DeInit(UART_HandleTypeDef *huart) {
+    HAL_UART_MspDeInit(huart);
+    huart->gState = HAL_UART_STATE_RESET;
+    huart->RxState = HAL_UART_STATE_RESET;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_UART_Transmit(UART_HandleTypeDef *huart, uint8_t *pData, uint16_t Size, uint32_t Timeout) {
+    (void)huart;
+    (void)Timeout;
+    fwrite(pData, 1, Size, stdout);
+    fflush(stdout);
+    return HAL_OK;
+}
+
+// Only USART2 has its TX DMA wired up, as on the board.
+HAL_StatusTypeDef HAL_UART_Transmit_DMA(UART_HandleTypeDef *huart, uint8_t *pData, uint16_t Size) {
+    static pthread_t thread;
+    static bool started = false;
+    if ((huart->Instance != USART2) || (huart->hdmatx == NULL) ||
+        (pData == NULL) || (Size == 0)) {
+        return HAL_ERROR;
+    }
+    if (huart->gState != HAL_UART_STATE_READY) {
+        return HAL_BUSY;
+    }
+    if (!started) {
+        started = (pthread_create(&thread, NULL, &DmaTxThread, NULL) == 0);
+        if (!started) {
+            return HAL_ERROR;
+        }
+    }
+    huart->gState = HAL_UART_STATE_BUSY_TX;
+    huart->pTxBuffPtr = pData;
+    huart->TxXferSize = Size;
+    huart->hdmatx->XferCpltCallback = DmaTxCplt;
+    pthread_mutex_lock(&dmaMutex);
+    dmaTxUart = huart;
+    pthread_cond_signal(&dmaCond);
+    pthread_mutex_unlock(&dmaMutex);
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_TIM_PWM_Init(TIM_HandleTypeDef *htim) {
+    if (htim->State == HAL_TIM_STATE_RESET) {
+        htim->Lock = HAL_UNLOCKED;
+        HAL_TIM_PWM_MspInit(htim);
+    }
+    htim->State = HAL_TIM_STATE_READY;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_TIM_PWM_ConfigChannel(TIM_HandleTypeDef *htim, TIM_OC_InitTypeDef *sConfig, uint32_t Channel) {
+    (void)htim;
+    (void)sConfig;
+    (void)Channel;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_TIM_PWM_Start(TIM_HandleTypeDef *htim, uint32_t Channel) {
+    (void)htim;
+    (void)Channel;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_TIM_PWM_Stop(TIM_HandleTypeDef *htim, uint32_t Channel) {
+    (void)htim;
+    (void)Channel;
+    return HAL_OK;
+}
+
+void BSP_LED_Init(Led_TypeDef Led) {
+    (void)Led;
+}
+
+void BSP_LED_DeInit(Led_TypeDef Led) {
+    (void)Led;
+}
+
+void BSP_LED_On(Led_TypeDef Led) {
+    (void)Led;
+}
+
+void BSP_LED_Off(Led_TypeDef Led) {
+    (void)Led;
+}
+
+} // extern "C"
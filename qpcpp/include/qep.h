@@ -172,6 +172,9 @@ extern char_t const versionStr[6];
     private:
         uint8_t poolId_;          //!< pool ID (0 for static event)
         uint8_t volatile refCtr_; //!< reference counter
+#ifdef QF_EVT_LATENCY
+        uint32_t stamp_;          //!< time of last post  // Gallium - added
+#endif
 
         friend class QF;
         friend class QMActive;
@@ -202,6 +205,9 @@ extern char_t const versionStr[6];
         QSignal sig;              //!< signal of the event instance
         uint8_t poolId_;          //!< pool ID (0 for static event)
         uint8_t volatile refCtr_; //!< reference counter
+#ifdef QF_EVT_LATENCY
+        uint32_t stamp_;          //!< time of last post  // Gallium - added
+#endif
     };
 
 #endif // Q_EVT_CTOR
@@ -462,6 +468,8 @@ private:
     friend class QXThread;
     friend class QXMutex;
     friend class QXSemaphore;
+    friend class QXMsgQueue;  // Gallium - added
+    friend class QXPiMutex;   // Gallium - added
 };
 
 //****************************************************************************
@@ -156,6 +156,15 @@ private:
     /// @sa QP::QF::getQueueMin().
     QEQueueCtr m_nMin;
 
+#ifdef QF_EQUEUE_STATS
+    // Gallium - added
+    //! total number of events posted to the queue
+    uint32_t m_nPost;
+
+    //! total number of posts rejected for lack of free entries
+    uint32_t m_nReject;
+#endif
+
 public:
     //! public default constructor
     QEQueue(void);
@@ -224,6 +233,29 @@ public:
         return m_nFree;
     }
 
+    // Gallium - added
+    //! minimum number of free entries ever in the queue (low-watermark)
+    QEQueueCtr getNMin(void) const {
+        return m_nMin;
+    }
+
+    //! total capacity of the queue, including the front event
+    QEQueueCtr getCapacity(void) const {
+        return m_end + static_cast<QEQueueCtr>(1);
+    }
+
+#ifdef QF_EQUEUE_STATS
+    //! total number of events posted to the queue
+    uint32_t getNPost(void) const {
+        return m_nPost;
+    }
+
+    //! total number of posts rejected for lack of free entries
+    uint32_t getNReject(void) const {
+        return m_nReject;
+    }
+#endif
+
     //! "raw" thread-safe QF event queue operation to find out if the queue
     //! is empty
     /// @note
@@ -239,6 +271,10 @@ public:
     }
 
 private:
+    // Gallium - added
+    //! Inserts an event at the back of the queue (FIFO), see qf_pkg.h.
+    bool insert_(QEvt const * const e);
+
     //! disallow copying of QEQueue
     QEQueue(QEQueue const &);
 
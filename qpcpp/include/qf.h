@@ -72,6 +72,22 @@
     #define QF_TIMEEVT_CTR_SIZE  2
 #endif
 
+#ifdef QF_TIMEEVT_WHEEL
+    // Gallium - added
+    #ifndef QF_TIMEEVT_WHEEL_BITS
+        //! log2 of the number of slots per level of the timing wheel
+        #define QF_TIMEEVT_WHEEL_BITS    4
+    #endif
+
+    //! number of slots per level of the timing wheel
+    #define QF_TIMEEVT_WHEEL_SLOTS   (1U << QF_TIMEEVT_WHEEL_BITS)
+
+    //! number of levels to cover the full range of QP::QTimeEvtCtr
+    #define QF_TIMEEVT_WHEEL_LEVELS \
+        (((QF_TIMEEVT_CTR_SIZE * 8) + QF_TIMEEVT_WHEEL_BITS - 1) \
+         / QF_TIMEEVT_WHEEL_BITS)
+#endif // QF_TIMEEVT_WHEEL
+
 
 //****************************************************************************
 namespace QP {
@@ -176,6 +192,37 @@ public: // for access from extern "C" functions
     //! QF priority associated with the active object.
     uint_fast8_t m_prio;
 
+#ifdef QF_COALESCE_MAX_SIG
+    // Gallium - added
+    //! Bitmask of coalesced signals with an instance in the event queue.
+    uint32_t m_coalescePend[QF_COALESCE_MAX_SIG / 32];
+#endif
+
+#ifdef QF_ACTIVE_CTRL_QUEUE
+    // Gallium - added
+    //! Control queue, drained before m_eQueue. Unused until setCtrlQueue().
+    QEQueue m_ctrlQueue;
+#endif
+
+#ifdef QF_ISR_POST_LOCKFREE
+    // Gallium - added
+    //! Inbox of events posted by ISRs without a critical section. The AO
+    //! moves them to m_eQueue. Unused until setIsrInbox().
+    QEvt const **m_isrSto;
+
+    //! Number of events in the ISR inbox.
+    uint32_t volatile m_isrCount;
+
+    //! Length of the ISR inbox.
+    uint32_t m_isrLen;
+#endif
+
+private:
+    // Gallium - added
+    //! Maximum number of events dispatched back-to-back in one activation,
+    //! see setBurst().
+    uint_fast8_t m_burst;
+
 protected:
     //! protected constructor (abstract class)
     QActive(QStateHandler const initial);
@@ -210,6 +257,55 @@ public:
     //! using the Last-In-First-Out (LIFO) policy.
     virtual void postLIFO(QEvt const * const e);
 
+#ifdef QF_ACTIVE_CTRL_QUEUE
+    // Gallium - added
+    //! Posts an event to the control queue of the active object (FIFO).
+    //! Control events are dispatched before any event in the regular queue.
+    void postCtrl(QEvt const * const e);
+
+    //! Provides the storage of the control queue. It must be called before
+    //! postCtrl() is used, typically right before start().
+    void setCtrlQueue(QEvt const *qSto[], uint_fast16_t const qLen) {
+        m_ctrlQueue.init(qSto, qLen);
+    }
+
+#endif
+
+#ifdef QF_ISR_POST_LOCKFREE
+    // Gallium - added
+    //! Provides the storage of the ISR inbox. Once set, post_() called from
+    //! an ISR reserves an inbox entry with an atomic operation instead of
+    //! disabling interrupts. It must be called before start().
+    /// @note postLIFO() must not be called from an ISR for such an AO. It
+    /// asserts if it is.
+    void setIsrInbox(QEvt const *sto[], uint_fast16_t const len) {
+        m_isrSto = &sto[0];
+        m_isrLen = static_cast<uint32_t>(len);
+    }
+
+    //! Lock-free post_() from an ISR (see setIsrInbox()).
+    bool postFromIsr_(QEvt const * const e, uint_fast16_t const margin);
+
+    //! Moves the events of the ISR inbox to m_eQueue. Must be called in a
+    //! critical section.
+    void drainIsrInbox_(void);
+#endif
+
+#if (defined QF_ACTIVE_CTRL_QUEUE) || (defined QF_ISR_POST_LOCKFREE)
+    // Gallium - added
+    //! Tests if all event queues of the active object are empty.
+    bool isQueueEmpty_(void) const {
+        return m_eQueue.isEmpty()
+#ifdef QF_ACTIVE_CTRL_QUEUE
+               && m_ctrlQueue.isEmpty()
+#endif
+#ifdef QF_ISR_POST_LOCKFREE
+               && (m_isrCount == static_cast<uint32_t>(0))
+#endif
+               ;
+    }
+#endif
+
     //! Un-subscribes from the delivery of all signals to the active object.
     void unsubscribeAll(void) const;
 
@@ -229,6 +325,20 @@ public:
     //! Recall a deferred event from a given event queue.
     bool recall(QEQueue * const eq);
 
+    // Gallium - added
+    //! Predicate selecting deferred events to recall (see recallIf()).
+    typedef bool (*RecallPred)(QEvt const * const e, void * const arg);
+
+    //! Recall all deferred events from a given event queue in one pass.
+    uint_fast16_t recallAll(QEQueue * const eq);
+
+    //! Recall the deferred events matching @p pred in one pass.
+    uint_fast16_t recallIf(QEQueue * const eq, RecallPred const pred,
+                           void * const arg);
+
+    //! Recall the deferred events with signal @p sig in one pass.
+    uint_fast16_t recallSig(QEQueue * const eq, enum_t const sig);
+
     //! Flush the specified deferred queue 'eq'.
     uint_fast16_t flushDeferred(QEQueue * const eq) const;
 
@@ -242,6 +352,20 @@ public:
         m_prio = prio;
     }
 
+    // Gallium - added
+    //! Opt-in burst mode (QXK only). Up to @p burst queued events are
+    //! dispatched back-to-back in one activation, as long as no thread of
+    //! higher priority is ready. The default of 1 disables burst mode.
+    void setBurst(uint_fast8_t const burst) {
+        m_burst = (burst > static_cast<uint_fast8_t>(0))
+                  ? burst : static_cast<uint_fast8_t>(1);
+    }
+
+    //! The burst set by setBurst().
+    uint_fast8_t getBurst(void) const {
+        return m_burst;
+    }
+
 #ifdef QF_OS_OBJECT_TYPE
     //! accessor to the OS-object for extern "C" functions, such as
     //! the QK scheduler
@@ -268,6 +392,8 @@ public:
     friend class QXThread;
     friend class QXMutex;
     friend class QXSemaphore;
+    friend class QXMsgQueue;  // Gallium - added
+    friend class QXPiMutex;   // Gallium - added
 #endif // qxk_h
 };
 
@@ -353,6 +479,11 @@ private:
 /// list, so only armed time events consume CPU cycles.
 ///
 /// @note
+/// When #QF_TIMEEVT_WHEEL is defined, the armed time events are kept in a
+/// hierarchical timing wheel instead (see QP::QTimeWheel), and a clock tick
+/// only visits the time events that expire or cascade in it.
+///
+/// @note
 /// QF manages the time events in the macro TICK_X(), which must be
 /// called periodically, eitehr from a clock tick ISR, or from a task level.
 ///
@@ -377,6 +508,9 @@ private:
     /// The down-counter is decremented by 1 in every TICK_X()
     /// invocation. The time event fires (gets posted or published) when
     /// the down-counter reaches zero.
+    /// @n
+    /// Gallium - When #QF_TIMEEVT_WHEEL is defined, it is not decremented
+    /// but only tells whether the time event is armed (see m_expiry).
     QTimeEvtCtr volatile m_ctr;
 
     //! the interval for the periodic time event (zero for the one-shot
@@ -387,6 +521,21 @@ private:
     /// keeps timing out periodically.
     QTimeEvtCtr m_interval;
 
+#ifdef QF_TIMEEVT_WHEEL
+    // Gallium - added
+    //! link to the m_next of the previous time event or to the slot head
+    QTimeEvt * volatile *m_pprev;
+
+    //! the tick at which the time event expires (see QTimeWheel::m_now)
+    QTimeEvtCtr m_expiry;
+
+    //! the tick at which the time event is due before applying m_slack
+    QTimeEvtCtr m_nominal;
+
+    //! number of ticks the expiry may be delayed to coalesce with others
+    QTimeEvtCtr m_slack;
+#endif // QF_TIMEEVT_WHEEL
+
 public:
 
     //! The Time Event constructor.
@@ -395,7 +544,8 @@ public:
 
     //! Arm a time event (one shot or periodic) for event posting.
     void armX(QTimeEvtCtr const nTicks,
-              QTimeEvtCtr const interval = static_cast<QTimeEvtCtr>(0));
+              QTimeEvtCtr const interval = static_cast<QTimeEvtCtr>(0),
+              QTimeEvtCtr const slack = static_cast<QTimeEvtCtr>(0));
 
     //! Disarm a time event.
     bool disarm(void);
@@ -424,6 +574,13 @@ public:
         // time event must be static, see NOTE01
         poolId_ = static_cast<uint8_t>(0); // not from any event pool
         refCtr_ = static_cast<uint8_t>(0); // default rate 0, see NOTE02
+#ifdef QF_TIMEEVT_WHEEL
+        // Gallium - added
+        m_pprev   = static_cast<QTimeEvt * volatile *>(0);
+        m_expiry  = static_cast<QTimeEvtCtr>(0);
+        m_nominal = static_cast<QTimeEvtCtr>(0);
+        m_slack   = static_cast<QTimeEvtCtr>(0);
+#endif // QF_TIMEEVT_WHEEL
     }
 
     //! @deprecated interface provided for backwards compatibility.
@@ -455,6 +612,19 @@ private:
     //! encapsulate the cast the m_act attribute to QTimeEvt*
     QTimeEvt *toTimeEvt(void) { return static_cast<QTimeEvt *>(m_act); }
 
+#ifdef QF_TIMEEVT_WHEEL
+    // Gallium - added
+    //! Link into the timing wheel to expire in @p nTicks (in crit. section)
+    void link_(QTimeEvtCtr const nTicks);
+
+    //! Unlink from the timing wheel (in critical section)
+    void unlink_(void);
+
+    //! Link to be due in @p nTicks, delayed by up to m_slack ticks to
+    //! coalesce with other time events (in critical section)
+    void linkSlack_(QTimeEvtCtr const nTicks);
+#endif // QF_TIMEEVT_WHEEL
+
     friend class QF;
 #ifdef qxk_h
     friend class QXThread;
@@ -463,6 +633,41 @@ private:
 };
 
 
+#ifdef QF_TIMEEVT_WHEEL
+// Gallium - added
+//****************************************************************************
+//! Hierarchical timing wheel of one clock tick rate
+/// @description
+/// Level k has #QF_TIMEEVT_WHEEL_SLOTS slots, each spanning
+/// 2^(k * #QF_TIMEEVT_WHEEL_BITS) ticks. An armed time event is linked into
+/// the lowest level that can hold its remaining ticks, in the slot of its
+/// expiry tick. When the slots of a level wrap around, QP::QF::tickX_()
+/// moves (cascades) the time events of the current slot of the level above
+/// into lower levels. Arming and disarming are O(1), and a tick is O(number
+/// of time events expiring or cascading).
+///
+struct QTimeWheel {
+    //! heads of the doubly-linked lists of time events in every slot
+    QTimeEvt * volatile m_slot[QF_TIMEEVT_WHEEL_LEVELS]
+                              [QF_TIMEEVT_WHEEL_SLOTS];
+
+    //! the slot being cascaded or expired by QP::QF::tickX_()
+    QTimeEvt * volatile m_pend;
+
+    //! ticks elapsed at this rate (wraps around)
+    QTimeEvtCtr volatile m_now;
+
+    //! number of armed time events
+    uint_fast16_t m_nArmed;
+
+    //! number of ticks at which any time event expired
+    uint32_t m_nExpiryTicks;
+
+    //! number of time event expirations
+    uint32_t m_nExpired;
+};
+#endif // QF_TIMEEVT_WHEEL
+
 //****************************************************************************
 //! Subscriber List
 /// @description
@@ -471,6 +676,25 @@ private:
 /// bit corresponds to the unique priority of an active object.
 typedef QPSet QSubscrList;
 
+#ifdef QF_SUBSCR_COMPACT
+// Gallium - added
+//! Compact subscription
+/// @description
+/// A subscription encodes the signal in the upper bits and the priority of
+/// the subscriber in the lower #QF_SUBSCR_PRIO_BITS bits. The array of
+/// subscriptions is kept sorted, so all subscribers of a signal are adjacent
+/// and are found by binary search. RAM usage grows with the number of
+/// subscriptions rather than the number of signals.
+typedef uint16_t QSubscr;
+
+#define QF_SUBSCR_PRIO_BITS     6
+#define QF_SUBSCR_PRIO_MASK     ((1U << QF_SUBSCR_PRIO_BITS) - 1U)
+#define QF_SUBSCR_KEY(sig_, prio_) \
+    static_cast<QSubscr>((static_cast<uint_fast16_t>(sig_) \
+                          << QF_SUBSCR_PRIO_BITS) \
+                         | static_cast<uint_fast16_t>(prio_))
+#endif // QF_SUBSCR_COMPACT
+
 
 //****************************************************************************
 //! QF services.
@@ -488,9 +712,22 @@ public:
     //! QF initialization.
     static void init(void);
 
+#ifdef QF_COALESCE_MAX_SIG
+    // Gallium - added
+    //! Mark signal @p sig as coalesced.
+    static void setCoalesce(enum_t const sig);
+#endif
+
     //! Publish-subscribe initialization.
+#ifdef QF_SUBSCR_COMPACT
+    // Gallium - added
+    static void psInit(QSubscr * const subscrSto,
+                       uint_fast16_t const maxSubscr,
+                       enum_t const maxSignal);
+#else
     static void psInit(QSubscrList * const subscrSto,
                        enum_t const maxSignal);
+#endif // QF_SUBSCR_COMPACT
 
     //! Event pool initialization for dynamic allocation of events.
     static void poolInit(void * const poolSto, uint_fast32_t const poolSize,
@@ -526,10 +763,27 @@ public:
 
 #endif // Q_SPY
 
+    // Gallium - added
+    //! Returns true if any active object subscribes to @p sig.
+    static bool hasSubscriber(enum_t const sig);
+
     //! Returns true if all time events are inactive and false
     //! any time event is active.
     static bool noTimeEvtsActiveX(uint8_t const tickRate);
 
+#ifdef QF_TIMEEVT_WHEEL
+    // Gallium - added
+    //! Number of ticks at which any time event expired.
+    static uint32_t getExpiryTicksX(uint8_t const tickRate) {
+        return timeWheel_[tickRate].m_nExpiryTicks;
+    }
+
+    //! Number of time event expirations.
+    static uint32_t getExpiredX(uint8_t const tickRate) {
+        return timeWheel_[tickRate].m_nExpired;
+    }
+#endif // QF_TIMEEVT_WHEEL
+
 
     //! This function returns the minimum of free entries of the given
     //! event pool.
@@ -546,6 +800,35 @@ public:
     //! Recycle a dynamic event.
     static void gc(QEvt const *e);
 
+#ifdef QF_EVT_TRACKER
+    // Gallium - added
+    //! Callback invoked after a dynamic event has been allocated.
+    static void onEvtNew(QEvt const * const e);
+
+    //! Callback invoked before a dynamic event is returned to its pool.
+    static void onEvtGc(QEvt const * const e);
+#endif // QF_EVT_TRACKER
+
+#ifdef QF_EVT_LATENCY
+    // Gallium - added
+    //! Callback invoked by the kernel before dispatching event @p e to the
+    //! AO of priority @p prio.
+    static void onEvtDispatch(uint_fast8_t const prio, QEvt const * const e);
+
+    //! Time event @p e was last posted, see #QF_EVT_STAMP.
+    static uint32_t getEvtStamp(QEvt const * const e) {
+        return e->stamp_;
+    }
+
+    //! Tests if event @p e carries a stamp. Static events are not stamped
+    //! since they may be in read-only memory, except for the tick event of
+    //! QTicker (signal 0), which QTicker stamps itself.
+    static bool hasEvtStamp(QEvt const * const e) {
+        return (e->poolId_ != static_cast<uint8_t>(0))
+               || (e->sig == static_cast<QSignal>(0));
+    }
+#endif // QF_EVT_LATENCY
+
     //! Internal QF implementation of the event reference creator
     static QEvt const *newRef_(QEvt const * const e,
                                QEvt const * const evtRef);
@@ -568,8 +851,14 @@ public:
 // to be used in QF ports only...
 private:
 
+#ifdef QF_TIMEEVT_WHEEL
+    // Gallium - added
+    //! timing wheels, one for every clock tick rate
+    static QTimeWheel timeWheel_[QF_MAX_TICK_RATE];
+#else
     //! heads of linked lists of time events, one for every clock tick rate
     static QTimeEvt timeEvtHead_[QF_MAX_TICK_RATE];
+#endif // QF_TIMEEVT_WHEEL
 
     friend class QActive;
     friend class QTimeEvt;
@@ -603,6 +892,12 @@ public:
                        void const * const sender);
 #endif
     virtual void postLIFO(QEvt const * const e);
+
+private:
+    // Gallium - added
+    // The tick rate used to be kept in m_eQueue.m_head, which is reset when
+    // QActive::start() initializes the event queue.
+    uint8_t m_tickRate;
 };
 
 } // namespace QP
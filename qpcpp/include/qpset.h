@@ -135,6 +135,15 @@ public:
             static_cast<uint32_t>(1) << (n - static_cast<uint_fast8_t>(1)));
     }
 
+#ifdef QF_ISR_POST_LOCKFREE
+    // Gallium - added
+    //! insert element @p n into the set atomically, from an ISR only
+    void insertAtomic(uint_fast8_t const n) {
+        (void)QF_atomicOr_(&m_bits, static_cast<uint32_t>(
+            static_cast<uint32_t>(1) << (n - static_cast<uint_fast8_t>(1))));
+    }
+#endif
+
     //! remove element @p n from the set, n = 1..8
     void remove(uint_fast8_t const n) {
         m_bits &= static_cast<uint32_t>(
@@ -145,6 +154,15 @@ public:
     uint_fast8_t findMax(void) const {
         return QF_LOG2(m_bits);
     }
+
+    // Gallium - added
+    //! Evaluates to true if the priority set has exactly one element
+    bool hasOneElement(void) const {
+        uint32_t const bits = m_bits;
+        return (bits != static_cast<uint32_t>(0))
+               && ((bits & (bits - static_cast<uint32_t>(1)))
+                   == static_cast<uint32_t>(0));
+    }
 };
 
 #else // QF_MAX_ACTIVE > 32
@@ -206,6 +224,21 @@ public:
         }
     }
 
+#ifdef QF_ISR_POST_LOCKFREE
+    // Gallium - added
+    //! insert element @p n into the set atomically, from an ISR only
+    void insertAtomic(uint_fast8_t const n) {
+        if (n <= static_cast<uint_fast8_t>(32)) {
+            (void)QF_atomicOr_(&m_bits[0], (static_cast<uint32_t>(1)
+                               << (n - static_cast<uint_fast8_t>(1))));
+        }
+        else {
+            (void)QF_atomicOr_(&m_bits[1], (static_cast<uint32_t>(1)
+                               << (n - static_cast<uint_fast8_t>(33))));
+        }
+    }
+#endif
+
     //! remove element @p n from the set, n = 1..64
     void remove(uint_fast8_t const n) {
         if (n <= static_cast<uint_fast8_t>(32)) {
@@ -224,6 +257,20 @@ public:
             ? (QF_LOG2(m_bits[1]) + static_cast<uint_fast8_t>(32)) \
             : (QF_LOG2(m_bits[0]));
     }
+
+    // Gallium - added
+    //! Evaluates to true if the priority set has exactly one element
+    bool hasOneElement(void) const {
+        uint32_t const bits0 = m_bits[0];
+        uint32_t const bits1 = m_bits[1];
+        uint32_t const bits = (bits0 != static_cast<uint32_t>(0))
+                              ? bits0 : bits1;
+        return (bits != static_cast<uint32_t>(0))
+               && ((bits0 == static_cast<uint32_t>(0))
+                   || (bits1 == static_cast<uint32_t>(0)))
+               && ((bits & (bits - static_cast<uint32_t>(1)))
+                   == static_cast<uint32_t>(0));
+    }
 };
 
 #endif // QF_MAX_ACTIVE
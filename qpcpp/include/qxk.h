@@ -125,6 +125,37 @@ public:
     /// @sa QP::QF::onIdle()
     static void onIdle(void);
 
+#ifdef QXK_CPU_LOAD
+    // Gallium - added
+    //! Causes of a context switch
+    enum SwCause {
+        SW_POST,    //!< thread made ready at task level (post, signal, etc)
+        SW_ISR,     //!< thread made ready by an ISR (QXK_ISR_EXIT())
+        SW_UNLOCK,  //!< scheduler lock or mutex released
+        SW_BLOCK,   //!< current thread blocked or terminated
+        SW_NEXT,    //!< RTC step completed and next AO activated
+        SW_RESUME   //!< preempted thread resumed
+    };
+
+    //! Callback invoked when the thread running at task level is about to
+    //! change to the one of priority @p prio (0 for the idle thread), for the
+    //! reason @p cause (see QP::QXK::SwCause).
+    /// @note Invoked with interrupts disabled, possibly from an ISR. In that
+    /// case the new thread runs after the ISR returns.
+    static void onContextSw(uint_fast8_t const prio,
+                            uint_fast8_t const cause);
+
+    //! Callbacks invoked by QXK_ISR_ENTRY() and QXK_ISR_EXIT() with
+    //! interrupts disabled.
+    static void onIsrEntry(void);
+    static void onIsrExit(void);
+
+    //! Callbacks invoked with interrupts enabled before and after the AO of
+    //! priority @p prio dispatches event @p e (i.e. around each RTC step).
+    static void onRtcBegin(uint_fast8_t const prio, QEvt const * const e);
+    static void onRtcEnd(uint_fast8_t const prio);
+#endif // QXK_CPU_LOAD
+
     //! get the current QXK version number string of the form X.Y.Z
     static char_t const *getVersion(void) {
         return versionStr;
@@ -151,6 +182,7 @@ private:
     uint_fast8_t m_prevHolder; //!< priority of the thread holding the lock
 
     friend class QF;
+    friend class QActive; // Gallium - added, for QF_SCHED_LOCK_() in subscribe()
 };
 
 } // namespace QP
@@ -206,6 +238,12 @@ private:
         } \
     } while (false)
 
+    // Gallium - added
+    // Lock-free post from ISRs. The scheduling is done by QXK_ISR_EXIT().
+    #define QF_ISR_CONTEXT_()   QXK_ISR_CONTEXT_()
+    #define QACTIVE_EQUEUE_SIGNAL_ATOMIC_(me_) \
+        QXK_attr_.readySet.insertAtomic((me_)->m_prio)
+
     // QXK-specific native QF event pool operations...
     #define QF_EPOOL_TYPE_  QMPool
     #define QF_EPOOL_INIT_(p_, poolSto_, poolSize_, evtSize_) \
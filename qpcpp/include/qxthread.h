@@ -119,6 +119,16 @@ public:
     //! using the Last-In-First-Out (LIFO) policy.
     virtual void postLIFO(QEvt const * const e);
 
+    // Gallium - added
+    //! Size of the private stack in bytes
+    uint_fast16_t getStackSize(void) const {
+        return m_stkSize;
+    }
+
+    //! High-watermark of the private stack in bytes, i.e. the part no
+    //! longer holding the fill pattern of QXK_stackInit_()
+    uint_fast16_t getStackUsed(void) const;
+
 private:
     void block_(void) const;
     void unblock_(void) const;
@@ -128,9 +138,13 @@ private:
 
     // attributes...
     QTimeEvt m_timeEvt;
+    void *m_stkSto;          // Gallium - added
+    uint_fast16_t m_stkSize; // Gallium - added
 
     // friendships...
     friend class QXSemaphore;
+    friend class QXMsgQueue; // Gallium - added
+    friend class QXPiMutex;  // Gallium - added
 };
 
 //! no-timeout sepcification when blocking on queues or semaphores
@@ -155,6 +169,87 @@ private:
     QPSet m_waitSet; //!< set of extended threads waiting on this semaphore
 };
 
+//****************************************************************************
+// Gallium - added
+//! Bounded queue of fixed-size messages of the QXK preemptive kernel
+/// @description
+/// Messages are copied in and out of the ring buffer inside a critical
+/// section, so they should be small (e.g. an I/O request descriptor or a
+/// pointer to one). Extended threads can block on both ends with a timeout.
+/// ISRs and basic threads (AOs) can only put, without blocking. A woken
+/// thread that finds the message or slot taken by another thread blocks
+/// again with the full timeout.
+///
+class QXMsgQueue {
+public:
+    //! initialize the message queue
+    void init(void * const qSto, uint_fast16_t const msgSize,
+              uint_fast16_t const qLen);
+
+    //! put a copy of a message at the back (block while full)
+    bool put(void const * const msg, uint_fast16_t const nTicks,
+             uint_fast8_t const tickRate);
+
+    //! get a copy of the message at the front (block while empty)
+    bool get(void * const msg, uint_fast16_t const nTicks,
+             uint_fast8_t const tickRate);
+
+    //! minimum number of free slots seen so far
+    uint_fast16_t getNMin(void) const {
+        return m_nMin;
+    }
+
+private:
+    void wake_(QPSet * const waitSet);
+
+    uint8_t *m_ring;          //!< storage of qLen messages
+    uint_fast16_t m_msgSize;  //!< size of a message [in bytes]
+    uint_fast16_t m_end;      //!< qLen
+    uint_fast16_t m_head;     //!< slot of the next put
+    uint_fast16_t m_tail;     //!< slot of the next get
+    uint_fast16_t m_nFree;
+    uint_fast16_t m_nMin;
+    QPSet m_getSet; //!< set of extended threads waiting for a message
+    QPSet m_putSet; //!< set of extended threads waiting for a free slot
+};
+
+//****************************************************************************
+// Gallium - added
+//! Priority-inheritance mutex of the QXK preemptive kernel
+/// @description
+/// Unlike the priority-ceiling QP::QXMutex, which locks the scheduler up to
+/// the ceiling, this mutex only boosts the thread holding it, and only while
+/// a higher-priority extended thread is blocked on it. Since QXK priorities
+/// are unique, the holder runs in the priority slot of the highest waiter,
+/// which is free while that waiter is blocked.
+///
+/// @note
+/// Only extended threads can lock it, one mutex at a time (no nesting).
+/// Like QP::QXMutex, the holder __cannot block__ (asserted when another
+/// thread contends). The waiters must not subscribe to published events,
+/// which are delivered by priority.
+///
+class QXPiMutex {
+public:
+    //! initialize the priority-inheritance mutex
+    void init(void);
+
+    //! lock the mutex (block while held by another thread)
+    void lock(void);
+
+    //! unlock the mutex and hand it over to the highest waiter
+    void unlock(void);
+
+private:
+    void boost_(void);
+    void unboost_(void);
+
+    QXThread *m_holder;        //!< thread holding the mutex, or NULL
+    QActive *m_lender;         //!< thread whose slot the holder runs in
+    uint_fast8_t m_holderPrio; //!< own priority of the holder
+    QPSet m_waitSet; //!< set of extended threads waiting on this mutex
+};
+
 } // namespace QP
 
 #endif // qxthread_h
@@ -44,6 +44,61 @@
 // The maximum number of system clock tick rates
 #define QF_MAX_TICK_RATE        2
 
+// Gallium - added
+// Track lifetime of dynamic events in debug build (see fw_tracker.h).
+#ifndef NDEBUG
+#define QF_EVT_TRACKER
+#endif
+
+// Gallium - added
+// Measure post-to-dispatch latency of events in debug build (see fw_latency.h).
+// Events are stamped with the DWT cycle counter (DWT->CYCCNT), which must be
+// enabled by the BSP. The stamp adds 4 bytes to every QEvt (8 instead of 4),
+// and so to every event class, which the event pool sizes must allow for.
+#ifndef NDEBUG
+#define QF_EVT_LATENCY
+#define QF_EVT_STAMP()          (*(uint32_t volatile *)0xE0001004U)
+#endif
+
+// Gallium - added
+// Enable coalescing of idempotent signals below this limit (see
+// QP::QF::setCoalesce()). Must be a multiple of 32.
+#define QF_COALESCE_MAX_SIG     128
+
+// Gallium - added
+// Measure the longest time interrupts are disabled by QF in debug build (see
+// QF_critMax_), with the same cycle counter as QF_EVT_STAMP().
+#ifndef NDEBUG
+#define QF_CRIT_PROFILE
+#endif
+
+// Gallium - added
+// Give each active object an optional control queue, which is always drained
+// before the regular event queue (see QP::QActive::postCtrl()).
+#define QF_ACTIVE_CTRL_QUEUE
+
+// Gallium - added
+// Count posts and rejected posts of every native event queue (see
+// QP::QEQueue::getNPost()).
+#define QF_EQUEUE_STATS
+
+// Gallium - added
+// Keep armed time events in a hierarchical timing wheel rather than a linear
+// list, so that a clock tick only visits the expiring ones (see
+// QP::QTimeWheel).
+#define QF_TIMEEVT_WHEEL
+
+// Gallium - added
+// Store subscriptions as a sorted array of (signal, priority) rather than
+// one QPSet per signal (see QP::QSubscr).
+#define QF_SUBSCR_COMPACT
+
+// Gallium - added
+// Report every change of the running thread, kernel-aware ISR entry/exit and
+// RTC step to the application for CPU load accounting (see
+// QP::QXK::onContextSw()).
+#define QXK_CPU_LOAD
+
 // QF interrupt disable/enable and log2()...
 #if (__ARM_ARCH == 6) /* Cortex-M0/M0+/M1 ?, see NOTE02 */
 
@@ -58,8 +113,14 @@
     #define QF_SET_BASEPRI(val_) __asm volatile (\
         "movs r0,%0 \n\t" \
         "msr  BASEPRI,r0" :: "I" (val_) : "cc", "r0")
-    #define QF_INT_DISABLE()    QF_SET_BASEPRI(QF_BASEPRI)
-    #define QF_INT_ENABLE()     QF_SET_BASEPRI(0U)
+    #define QF_INT_DISABLE()    do { \
+        QF_SET_BASEPRI(QF_BASEPRI); \
+        QF_CRIT_PROFILE_BEGIN_(); \
+    } while (false)
+    #define QF_INT_ENABLE()     do { \
+        QF_CRIT_PROFILE_END_(); \
+        QF_SET_BASEPRI(0U); \
+    } while (false)
 
     // NOTE: keep in synch with the value defined in "qk_port.s", NOTE4
     #define QF_BASEPRI          (0xFFU >> 2)
@@ -85,12 +146,81 @@
     do { \
         saved_ = __get_BASEPRI(); \
         __set_BASEPRI(QF_BASEPRI); \
+        if (saved_ == 0U) { \
+            QF_CRIT_PROFILE_BEGIN_(); \
+        } \
     } while(0)
 #define QF_CRIT_EXIT(saved_) \
     do { \
+        if (saved_ == 0U) { \
+            QF_CRIT_PROFILE_END_(); \
+        } \
         __set_BASEPRI(saved_); \
     } while(0)
 
+// Gallium - added
+#ifdef QF_CRIT_PROFILE
+    extern "C" uint32_t QF_critBegin_; // start of the current critical section
+    extern "C" uint32_t QF_critMax_;   // longest critical section in cycles
+    #define QF_CRIT_PROFILE_BEGIN_()    (QF_critBegin_ = QF_EVT_STAMP())
+    #define QF_CRIT_PROFILE_END_() do { \
+        uint32_t const d_ = QF_EVT_STAMP() - QF_critBegin_; \
+        if (d_ > QF_critMax_) { \
+            QF_critMax_ = d_; \
+        } \
+    } while (false)
+#else
+    #define QF_CRIT_PROFILE_BEGIN_()    ((void)0)
+    #define QF_CRIT_PROFILE_END_()      ((void)0)
+#endif
+
+
+// Gallium - added
+// Lock-free post of events from ISRs (see QP::QActive::setIsrInbox()). The
+// atomic read-modify-write operations below use LDREX/STREX and are only
+// called from ISRs. Threads update the same data in critical sections, which
+// kernel-aware ISRs cannot preempt. An exception clears the exclusive monitor,
+// so an ISR preempted by another one retries.
+#if (__ARM_ARCH != 6)
+#define QF_ISR_POST_LOCKFREE
+
+inline uint32_t QF_atomicOr_(uint32_t volatile * const p, uint32_t const bits) {
+    uint32_t old;
+    do {
+        old = __LDREXW(p);
+    } while (__STREXW(old | bits, p) != 0U);
+    return old;
+}
+
+inline void QF_atomicAdd_(uint32_t volatile * const p, uint32_t const n) {
+    uint32_t old;
+    do {
+        old = __LDREXW(p);
+    } while (__STREXW(old + n, p) != 0U);
+}
+
+// Increment *p if it is below limit. Returns the old value.
+inline uint32_t QF_atomicIncBelow_(uint32_t volatile * const p,
+                                   uint32_t const limit)
+{
+    uint32_t old;
+    do {
+        old = __LDREXW(p);
+        if (old >= limit) {
+            __CLREX();
+            return old;
+        }
+    } while (__STREXW(old + 1U, p) != 0U);
+    return old;
+}
+
+inline void QF_atomicIncU8_(uint8_t volatile * const p) {
+    uint8_t old;
+    do {
+        old = __LDREXB(p);
+    } while (__STREXB(static_cast<uint8_t>(old + 1U), p) != 0U);
+}
+#endif
 
 #include "qep_port.h"   // QEP port
 #include "qxk_port.h"   // QXK port
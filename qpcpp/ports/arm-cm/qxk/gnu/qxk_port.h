@@ -54,6 +54,8 @@ static inline uint32_t QXK_get_IPSR(void) {
         static_cast<uint32_t>(1U << 28))
 
 // QXK ISR entry and exit
+#ifndef QXK_CPU_LOAD
+
 #define QXK_ISR_ENTRY() ((void)0)
 
 #define QXK_ISR_EXIT()  do { \
@@ -64,6 +66,25 @@ static inline uint32_t QXK_get_IPSR(void) {
     QF_INT_ENABLE(); \
 } while (false)
 
+#else // Gallium - added
+
+#define QXK_ISR_ENTRY() do { \
+    QF_INT_DISABLE(); \
+    QP::QXK::onIsrEntry(); \
+    QF_INT_ENABLE(); \
+} while (false)
+
+#define QXK_ISR_EXIT()  do { \
+    QF_INT_DISABLE(); \
+    if (QXK_sched_() != static_cast<uint_fast8_t>(0)) { \
+        QXK_CONTEXT_SWITCH_(); \
+    } \
+    QP::QXK::onIsrExit(); \
+    QF_INT_ENABLE(); \
+} while (false)
+
+#endif // QXK_CPU_LOAD
+
 // initialization of the QXK kernel
 #define QXK_INIT() QXK_init()
 extern "C" {
@@ -0,0 +1,33 @@
+/// @file
+/// @brief QEP/C++ port to POSIX (host), generic C++ compiler
+/// @cond
+///***************************************************************************
+/// Gallium - added
+///
+/// Copyright (C) 2017 Gallium Studio LLC (Lawrence Lo). All rights reserved.
+///
+/// This program is open source software: you can redistribute it and/or
+/// modify it under the terms of the GNU General Public License as published
+/// by the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program. If not, see <http://www.gnu.org/licenses/>.
+///***************************************************************************
+/// @endcond
+
+#ifndef qep_port_h
+#define qep_port_h
+
+#include <stdint.h>  // Exact-width types. WG14/N843 C99 Standard
+
+#define Q_EVT_CTOR   // Gallium - added
+
+#include "qep.h"     // QEP platform-independent public interface
+
+#endif // qep_port_h
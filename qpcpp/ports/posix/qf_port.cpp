@@ -0,0 +1,145 @@
+/// @file
+/// @brief QF/C++ port to POSIX (host), QXK kernel, GNU toolset
+/// @cond
+///***************************************************************************
+/// Gallium - added
+///
+/// Copyright (C) 2017 Gallium Studio LLC (Lawrence Lo). All rights reserved.
+///
+/// This program is open source software: you can redistribute it and/or
+/// modify it under the terms of the GNU General Public License as published
+/// by the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program. If not, see <http://www.gnu.org/licenses/>.
+///***************************************************************************
+/// @endcond
+
+#define QP_IMPL           // this is QP implementation
+#include "qf_port.h"      // QF port
+#include "qxk_pkg.h"      // QXK package-scope internal interface
+#include "qassert.h"      // QP embedded systems-friendly assertions
+#ifdef Q_SPY              // QS software tracing enabled?
+    #include "qs_port.h"  // include QS port
+#else
+    #include "qs_dummy.h" // disable the QS software tracing
+#endif // Q_SPY
+
+#include <time.h>         // clock_nanosleep()
+
+Q_DEFINE_THIS_MODULE("qf_port")
+
+extern "C" {
+
+pthread_mutex_t QF_pThreadMutex_ = PTHREAD_RECURSIVE_MUTEX_INITIALIZER_NP;
+uint32_t QF_critNest_;
+__thread uint_fast8_t QXK_isrNest_;
+
+// signaled by QXK_pendSV_(), waited on by QXK_waitForIsr()
+static pthread_cond_t l_pendSV = PTHREAD_COND_INITIALIZER;
+
+static pthread_t l_clockThread;
+static uint32_t l_tickNsec;
+
+//****************************************************************************
+/// @description
+/// The clock thread calls QF_onClockTick() at absolute deadlines, so that
+/// the tick rate does not drift with the time taken by the callback.
+///
+static void *clockThread_(void *arg) {
+    (void)arg;
+    struct timespec next;
+    clock_gettime(CLOCK_MONOTONIC, &next);
+    for (;;) {
+        next.tv_nsec += l_tickNsec;
+        if (next.tv_nsec >= 1000000000L) {
+            next.tv_nsec -= 1000000000L;
+            ++next.tv_sec;
+        }
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next,
+                               static_cast<struct timespec *>(0)) != 0)
+        {
+            // interrupted by a signal, sleep again
+        }
+        QF_onClockTick();
+    }
+    return static_cast<void *>(0);
+}
+
+//****************************************************************************
+void QF_setTickRate(uint32_t ticksPerSec) {
+    /// @pre the rate must be between 1 and 1000000 ticks per second and
+    /// the clock thread must not be running yet
+    Q_REQUIRE_ID(100, (ticksPerSec != 0U) && (ticksPerSec <= 1000000U)
+                      && (l_tickNsec == 0U));
+
+    l_tickNsec = 1000000000U / ticksPerSec;
+    int err = pthread_create(&l_clockThread, static_cast<pthread_attr_t *>(0),
+                             &clockThread_, static_cast<void *>(0));
+    Q_ASSERT_ID(110, err == 0);
+}
+
+//****************************************************************************
+/// @note
+/// called from QXK_ISR_EXIT() with the critical section held
+///
+void QXK_pendSV_(void) {
+    pthread_cond_signal(&l_pendSV);
+}
+
+//****************************************************************************
+/// @description
+/// Blocks the main thread until QXK_sched_() finds a basic thread to run,
+/// then activates it, which is what the target does with WFI and PendSV.
+/// The critical section is released while waiting, so that the ISRs can run.
+///
+void QXK_waitForIsr(void) {
+    QF_INT_DISABLE();
+
+    /// @pre must be called from the idle loop, outside of any other
+    /// critical section
+    Q_REQUIRE_ID(200, (!QXK_ISR_CONTEXT_())
+                      && (QF_critNest_ == 1U)
+                      && (QXK_attr_.actPrio == static_cast<uint_fast8_t>(0)));
+
+    uint_fast8_t p = QXK_sched_();
+    if (p == static_cast<uint_fast8_t>(0)) { // nothing ready to run?
+        QF_critNest_ = 0U; // the mutex is released while waiting
+        QF_CRIT_PROFILE_END_();
+        pthread_cond_wait(&l_pendSV, &QF_pThreadMutex_);
+        QF_CRIT_PROFILE_BEGIN_();
+        QF_critNest_ = 1U;
+        p = QXK_sched_();
+#ifdef QXK_CPU_LOAD
+        QXK_swCause_ = QP::QXK::SW_ISR; // readied by the ISR that woke us
+#endif
+    }
+    if (p != static_cast<uint_fast8_t>(0)) {
+        QXK_activate_();
+    }
+    QF_INT_ENABLE();
+}
+
+//****************************************************************************
+/// @description
+/// Extended threads would need a host thread each, with the context switch
+/// handing the CPU from one to another. This port only supports basic
+/// threads.
+///
+void QXK_stackInit_(void *act, QP::QXThreadHandler handler,
+                    void *stkSto, uint_fast16_t stkSize)
+{
+    (void)act;
+    (void)handler;
+    (void)stkSto;
+    (void)stkSize;
+    Q_ERROR_ID(300);
+}
+
+} // extern "C"
@@ -0,0 +1,219 @@
+/// @file
+/// @brief QF/C++ port to POSIX (host), QXK kernel, GNU toolset
+/// @cond
+///***************************************************************************
+/// Gallium - added
+///
+/// Copyright (C) 2017 Gallium Studio LLC (Lawrence Lo). All rights reserved.
+///
+/// This program is open source software: you can redistribute it and/or
+/// modify it under the terms of the GNU General Public License as published
+/// by the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program. If not, see <http://www.gnu.org/licenses/>.
+///***************************************************************************
+/// @endcond
+
+#ifndef qf_port_h
+#define qf_port_h
+
+// This port runs the QXK kernel and the application in a single host process
+// for experiments away from the target, see NOTE1. The configuration below
+// mirrors the ARM Cortex-M port, so that the framework behaves the same.
+
+// The maximum number of active objects in the application
+#define QF_MAX_ACTIVE           32
+
+// The maximum number of system clock tick rates
+#define QF_MAX_TICK_RATE        2
+
+// Track lifetime of dynamic events in debug build (see fw_tracker.h).
+#ifndef NDEBUG
+#define QF_EVT_TRACKER
+#endif
+
+// Measure post-to-dispatch latency of events in debug build (see fw_latency.h).
+// Events are stamped with the virtual cycle counter of the BSP, see NOTE2.
+// The stamp adds 4 bytes to every QEvt, like on the target.
+#ifndef NDEBUG
+#define QF_EVT_LATENCY
+#define QF_EVT_STAMP()          (QF_getCycleCnt())
+#endif
+
+// Enable coalescing of idempotent signals below this limit (see
+// QP::QF::setCoalesce()). Must be a multiple of 32.
+#define QF_COALESCE_MAX_SIG     128
+
+// Measure the longest critical section of QF in debug build (see
+// QF_critMax_), with the same cycle counter as QF_EVT_STAMP().
+#ifndef NDEBUG
+#define QF_CRIT_PROFILE
+#endif
+
+// Give each active object an optional control queue, which is always drained
+// before the regular event queue (see QP::QActive::postCtrl()).
+#define QF_ACTIVE_CTRL_QUEUE
+
+// Count posts and rejected posts of every native event queue (see
+// QP::QEQueue::getNPost()).
+#define QF_EQUEUE_STATS
+
+// Keep armed time events in a hierarchical timing wheel rather than a linear
+// list (see QP::QTimeWheel).
+#define QF_TIMEEVT_WHEEL
+
+// Store subscriptions as a sorted array of (signal, priority) rather than
+// one QPSet per signal (see QP::QSubscr).
+#define QF_SUBSCR_COMPACT
+
+// Report every change of the running thread, kernel-aware ISR entry/exit and
+// RTC step to the application for CPU load accounting (see
+// QP::QXK::onContextSw()).
+#define QXK_CPU_LOAD
+
+// Extended threads are not supported, see NOTE1. QXThread::start() asserts,
+// so the application checks this to leave them out.
+#define QXK_NO_XTHREAD
+
+#include <stdint.h>     // Exact-width types. WG14/N843 C99 Standard
+#include <pthread.h>    // POSIX-thread API
+
+// QF interrupt disable/enable, see NOTE3
+#define QF_INT_DISABLE()    do { \
+    pthread_mutex_lock(&QF_pThreadMutex_); \
+    if (QF_critNest_++ == 0U) { \
+        QF_CRIT_PROFILE_BEGIN_(); \
+    } \
+} while (false)
+#define QF_INT_ENABLE()     do { \
+    if (--QF_critNest_ == 0U) { \
+        QF_CRIT_PROFILE_END_(); \
+    } \
+    pthread_mutex_unlock(&QF_pThreadMutex_); \
+} while (false)
+
+// All simulated ISRs are kernel-aware. NVIC priorities are ignored.
+#define QF_AWARE_ISR_CMSIS_PRI  0
+
+// fast log-base-2 with the GCC built-in. Unlike CLZ on the Cortex-M,
+// __builtin_clz(0) is undefined, while QPSet::findMax() relies on 0 for 0.
+#define QF_LOG2(x_) \
+    (((x_) != 0U) \
+     ? static_cast<uint_fast8_t>(32U - __builtin_clz(x_)) \
+     : static_cast<uint_fast8_t>(0))
+
+// QF critical section entry/exit. The mutex is recursive, so critical
+// sections nest like with the BASEPRI policy of the ARM Cortex-M port.
+#define QF_CRIT_STAT_TYPE       uint32_t
+#define QF_CRIT_ENTRY(saved_) do { \
+    (saved_) = 0U; \
+    QF_INT_DISABLE(); \
+} while (false)
+#define QF_CRIT_EXIT(saved_) do { \
+    (void)(saved_); \
+    QF_INT_ENABLE(); \
+} while (false)
+#define QF_CRIT_EXIT_NOP()      ((void)0)
+
+#ifdef QF_CRIT_PROFILE
+    extern "C" uint32_t QF_critBegin_; // start of the current critical section
+    extern "C" uint32_t QF_critMax_;   // longest critical section in cycles
+    #define QF_CRIT_PROFILE_BEGIN_()    (QF_critBegin_ = QF_EVT_STAMP())
+    #define QF_CRIT_PROFILE_END_() do { \
+        uint32_t const d_ = QF_EVT_STAMP() - QF_critBegin_; \
+        if (d_ > QF_critMax_) { \
+            QF_critMax_ = d_; \
+        } \
+    } while (false)
+#else
+    #define QF_CRIT_PROFILE_BEGIN_()    ((void)0)
+    #define QF_CRIT_PROFILE_END_()      ((void)0)
+#endif
+
+// Lock-free post of events from ISRs (see QP::QActive::setIsrInbox()). A
+// simulated ISR holds the critical section throughout (see QXK_ISR_ENTRY()),
+// so the GCC atomic built-ins are more than enough here.
+#define QF_ISR_POST_LOCKFREE
+
+inline uint32_t QF_atomicOr_(uint32_t volatile * const p, uint32_t const bits) {
+    return __sync_fetch_and_or(p, bits);
+}
+
+inline void QF_atomicAdd_(uint32_t volatile * const p, uint32_t const n) {
+    (void)__sync_fetch_and_add(p, n);
+}
+
+// Increment *p if it is below limit. Returns the old value.
+inline uint32_t QF_atomicIncBelow_(uint32_t volatile * const p,
+                                   uint32_t const limit)
+{
+    uint32_t old;
+    do {
+        old = *p;
+        if (old >= limit) {
+            return old;
+        }
+    } while (!__sync_bool_compare_and_swap(p, old, old + 1U));
+    return old;
+}
+
+inline void QF_atomicIncU8_(uint8_t volatile * const p) {
+    (void)__sync_fetch_and_add(p, static_cast<uint8_t>(1U));
+}
+
+extern "C" {
+
+//! the mutex guarding all QF critical sections
+extern pthread_mutex_t QF_pThreadMutex_;
+
+//! nesting depth of the critical section held by the owner of the mutex
+extern uint32_t QF_critNest_;
+
+//! start the clock thread, which calls QF_onClockTick() ticksPerSec times
+//! per second (must be called once, e.g. from QP::QF::onStartup())
+void QF_setTickRate(uint32_t ticksPerSec);
+
+//! clock tick callback, provided by the application. It is called from the
+//! clock thread and must be written like the SysTick ISR of the target.
+void QF_onClockTick(void);
+
+//! free-running cycle counter, provided by the application, see NOTE2
+uint32_t QF_getCycleCnt(void);
+
+} // extern "C"
+
+#include "qep_port.h"   // QEP port
+#include "qxk_port.h"   // QXK port
+#include "qf.h"         // QF platform-independent public interface
+#include "qxthread.h"   // QXK naked thread
+
+//****************************************************************************
+// NOTE1:
+// The QXK basic threads (all active objects) run in the main thread of the
+// process, which is the only thread to call QXK_activate_(). Interrupts are
+// simulated by other host threads (e.g. the clock thread of this port) that
+// execute the ISR code of the application between QXK_ISR_ENTRY() and
+// QXK_ISR_EXIT(). A host thread cannot be preempted at an arbitrary
+// instruction, so an AO made ready by an ISR starts at the end of the RTC
+// step in progress, or from QXK_waitForIsr() when the main thread is idle,
+// rather than immediately. Extended threads are not supported.
+//
+// NOTE2:
+// There is no DWT cycle counter on the host. The BSP provides a virtual one,
+// e.g. derived from CLOCK_MONOTONIC at the core clock of the target, so that
+// cycle counts read the same as on the target.
+//
+// NOTE3:
+// "Disabling interrupts" locks a single recursive mutex, which the simulated
+// ISRs hold throughout. Like on the target, an ISR therefore never runs in
+// the middle of a critical section of a thread and vice versa.
+//
+
+#endif // qf_port_h
@@ -0,0 +1,46 @@
+/// @file
+/// @brief QS/C++ port to POSIX (host), generic C++ compiler
+/// @cond
+///***************************************************************************
+/// Gallium - added
+///
+/// Copyright (C) 2017 Gallium Studio LLC (Lawrence Lo). All rights reserved.
+///
+/// This program is open source software: you can redistribute it and/or
+/// modify it under the terms of the GNU General Public License as published
+/// by the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program. If not, see <http://www.gnu.org/licenses/>.
+///***************************************************************************
+/// @endcond
+
+#ifndef qs_port_h
+#define qs_port_h
+
+#define QS_TIME_SIZE        4
+
+#if defined(__LP64__) || defined(_LP64)  // 64-bit host?
+    #define QS_OBJ_PTR_SIZE 8
+    #define QS_FUN_PTR_SIZE 8
+#else
+    #define QS_OBJ_PTR_SIZE 4
+    #define QS_FUN_PTR_SIZE 4
+#endif
+
+//****************************************************************************
+// NOTE: QS might be used with or without other QP components, in which case
+// the separate definitions of the macros QF_CRIT_STAT_TYPE, QF_CRIT_ENTRY,
+// and QF_CRIT_EXIT are needed. In this port QS is configured to be used with
+// the QF framework, by simply including "qf_port.h" *before* "qs.h".
+//
+#include "qf_port.h" // use QS with QF
+#include "qs.h"      // QS platform-independent public interface
+
+#endif // qs_port_h
@@ -0,0 +1,86 @@
+/// @file
+/// @brief QXK/C++ port to POSIX (host), GNU toolset
+/// @cond
+///***************************************************************************
+/// Gallium - added
+///
+/// Copyright (C) 2017 Gallium Studio LLC (Lawrence Lo). All rights reserved.
+///
+/// This program is open source software: you can redistribute it and/or
+/// modify it under the terms of the GNU General Public License as published
+/// by the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program. If not, see <http://www.gnu.org/licenses/>.
+///***************************************************************************
+/// @endcond
+
+#ifndef qxk_port_h
+#define qxk_port_h
+
+// determination if the code executes in the ISR context
+#define QXK_ISR_CONTEXT_() (QXK_isrNest_ != static_cast<uint_fast8_t>(0))
+
+// wake up the main thread to activate the basic thread found by QXK_sched_()
+// (the job of PendSV on the target)
+#define QXK_CONTEXT_SWITCH_() (QXK_pendSV_())
+
+// QXK ISR entry and exit. The critical section is held from the entry to the
+// exit, so that the ISR runs atomically with respect to the threads.
+#ifndef QXK_CPU_LOAD
+
+#define QXK_ISR_ENTRY() do { \
+    QF_INT_DISABLE(); \
+    ++QXK_isrNest_; \
+} while (false)
+
+#define QXK_ISR_EXIT()  do { \
+    if (QXK_sched_() != static_cast<uint_fast8_t>(0)) { \
+        QXK_CONTEXT_SWITCH_(); \
+    } \
+    --QXK_isrNest_; \
+    QF_INT_ENABLE(); \
+} while (false)
+
+#else
+
+#define QXK_ISR_ENTRY() do { \
+    QF_INT_DISABLE(); \
+    ++QXK_isrNest_; \
+    QP::QXK::onIsrEntry(); \
+} while (false)
+
+#define QXK_ISR_EXIT()  do { \
+    if (QXK_sched_() != static_cast<uint_fast8_t>(0)) { \
+        QXK_CONTEXT_SWITCH_(); \
+    } \
+    QP::QXK::onIsrExit(); \
+    --QXK_isrNest_; \
+    QF_INT_ENABLE(); \
+} while (false)
+
+#endif // QXK_CPU_LOAD
+
+extern "C" {
+
+//! ISR nesting level of the calling host thread
+extern __thread uint_fast8_t QXK_isrNest_;
+
+//! signal the main thread waiting in QXK_waitForIsr()
+void QXK_pendSV_(void);
+
+//! wait until an ISR makes a basic thread ready to run and activate it. To be
+//! called from QP::QXK::onIdle() in place of the WFI instruction.
+void QXK_waitForIsr(void);
+
+} // extern "C"
+
+#include "qxk.h" // QXK platform-independent public interface
+
+#endif // qxk_port_h
@@ -53,6 +53,18 @@ Q_DEFINE_THIS_MODULE("qf_act")
 // public objects ************************************************************
 QActive *QF::active_[QF_MAX_ACTIVE + 1]; // to be used by QF ports only
 
+} // namespace QP
+
+#ifdef QF_CRIT_PROFILE
+// Gallium - added
+extern "C" {
+uint32_t QF_critBegin_; // start of the current critical section
+uint32_t QF_critMax_;   // longest critical section in cycles
+}
+#endif
+
+namespace QP {
+
 //****************************************************************************
 /// @description
 /// This function adds a given active object to the active objects managed
@@ -106,7 +106,41 @@ bool QActive::post_(QEvt const * const e, uint_fast16_t const margin,
     /// @pre event pointer must be valid
     Q_REQUIRE_ID(100, e != static_cast<QEvt const *>(0));
 
+#ifdef QF_ISR_POST_LOCKFREE
+    // Gallium - added
+    if ((m_isrSto != static_cast<QEvt const **>(0)) && QF_ISR_CONTEXT_()) {
+        return postFromIsr_(e, margin);
+    }
+#endif
+
     QF_CRIT_ENTRY_();
+
+#ifdef QF_ISR_POST_LOCKFREE
+    // Gallium - added
+    // Keep the order of events posted by ISRs before this one.
+    if (m_isrCount != static_cast<uint32_t>(0)) {
+        drainIsrInbox_();
+    }
+#endif
+
+#ifdef QF_COALESCE_MAX_SIG
+    // Gallium - added
+    // A coalesced signal already in the queue? The new instance is dropped as
+    // if it were posted and immediately consumed.
+    bool const coalesced = QF_isCoalesced_(e->sig);
+    if (coalesced
+        && ((m_coalescePend[QF_COALESCE_IDX_(e->sig)]
+             & QF_COALESCE_BIT_(e->sig)) != static_cast<uint32_t>(0)))
+    {
+        if (e->poolId_ != static_cast<uint8_t>(0)) {
+            QF_EVT_REF_CTR_INC_(e); // balanced by gc() below
+        }
+        QF_CRIT_EXIT_();
+        QF::gc(e);
+        return true;
+    }
+#endif // QF_COALESCE_MAX_SIG
+
     QEQueueCtr nFree = m_eQueue.m_nFree; // get volatile into the temporary
 
     // margin available?
@@ -125,30 +159,23 @@ bool QActive::post_(QEvt const * const e, uint_fast16_t const margin,
         // is it a dynamic event?
         if (e->poolId_ != static_cast<uint8_t>(0)) {
             QF_EVT_REF_CTR_INC_(e); // increment the reference counter
+#ifdef QF_EVT_LATENCY
+            // Gallium - added, static events may be in read-only memory
+            QF_EVT_CONST_CAST_(e)->stamp_ = QF_EVT_STAMP();
+#endif
         }
-
-        --nFree;  // one free entry just used up
-        m_eQueue.m_nFree = nFree;     // update the volatile
-        if (m_eQueue.m_nMin > nFree) {
-            m_eQueue.m_nMin = nFree;  // update minimum so far
+#ifdef QF_COALESCE_MAX_SIG
+        if (coalesced) { // Gallium - added
+            m_coalescePend[QF_COALESCE_IDX_(e->sig)] |=
+                QF_COALESCE_BIT_(e->sig);
         }
+#endif
 
-        // is the queue empty?
-        if (m_eQueue.m_frontEvt == static_cast<QEvt const *>(0)) {
-            m_eQueue.m_frontEvt = e;      // deliver event directly
+        // Gallium - changed, the insertion is shared with postCtrl()
+        // was the queue empty?
+        if (m_eQueue.insert_(e)) {
             QACTIVE_EQUEUE_SIGNAL_(this); // signal the event queue
         }
-        // queue is not empty, insert event into the ring-buffer
-        else {
-            // insert event pointer e into the buffer (FIFO)
-            QF_PTR_AT_(m_eQueue.m_ring, m_eQueue.m_head) = e;
-
-            // need to wrap head?
-            if (m_eQueue.m_head == static_cast<QEQueueCtr>(0)) {
-                m_eQueue.m_head = m_eQueue.m_end; // wrap around
-            }
-            --m_eQueue.m_head;
-        }
         QF_CRIT_EXIT_();
 
         status = true; // event posted successfully
@@ -157,6 +184,7 @@ bool QActive::post_(QEvt const * const e, uint_fast16_t const margin,
         /// @note assert if event cannot be posted and dropping events is
         /// not acceptable
         Q_ASSERT_ID(120, margin != static_cast<uint_fast16_t>(0));
+        QF_EQUEUE_REJECT_INC_(m_eQueue); // Gallium - added
 
         QS_BEGIN_NOCRIT_(QS_QF_ACTIVE_POST_ATTEMPT, QS::priv_.aoObjFilter,
                          this)
@@ -178,6 +206,29 @@ bool QActive::post_(QEvt const * const e, uint_fast16_t const margin,
     return status;
 }
 
+#ifdef QF_COALESCE_MAX_SIG
+// Gallium - added
+uint32_t QF_coalesceSig_[QF_COALESCE_MAX_SIG / 32];
+
+//****************************************************************************
+/// @description
+/// Marks signal @p sig as coalesced. It is meant for idempotent notifications
+/// ("something happened, go look"). When an instance of a coalesced signal is
+/// already in the event queue of an AO, posting another one to the same AO
+/// (FIFO) drops the new one in O(1), so bursts do not overflow the queue.
+/// It must be called before such signals are posted, e.g. after QF::init().
+///
+void QF::setCoalesce(enum_t const sig) {
+    /// @pre the signal must be in range
+    Q_REQUIRE_ID(800, (Q_USER_SIG <= sig)
+                      && (sig < static_cast<enum_t>(QF_COALESCE_MAX_SIG)));
+    QF_CRIT_STAT_
+    QF_CRIT_ENTRY_();
+    QF_coalesceSig_[QF_COALESCE_IDX_(sig)] |= QF_COALESCE_BIT_(sig);
+    QF_CRIT_EXIT_();
+}
+#endif // QF_COALESCE_MAX_SIG
+
 //****************************************************************************
 /// @description
 /// posts an event to the event queue of the active object  using the
@@ -193,7 +244,21 @@ bool QActive::post_(QEvt const * const e, uint_fast16_t const margin,
 void QActive::postLIFO(QEvt const * const e) {
     QF_CRIT_STAT_
 
+#ifdef QF_ISR_POST_LOCKFREE
+    // Gallium - added
+    /// @pre not called from an ISR for an AO with an ISR inbox, since it
+    /// could drain an entry reserved by a preempted postFromIsr_() before
+    /// the entry is written
+    Q_REQUIRE_ID(200, (m_isrSto == static_cast<QEvt const **>(0))
+                      || (!QF_ISR_CONTEXT_()));
+#endif
+
     QF_CRIT_ENTRY_();
+#ifdef QF_ISR_POST_LOCKFREE
+    if (m_isrCount != static_cast<uint32_t>(0)) { // Gallium - added
+        drainIsrInbox_();
+    }
+#endif
     QEQueueCtr nFree = m_eQueue.m_nFree;// tmp to avoid UB for volatile access
 
     // the queue must be able to accept the event (cannot overflow)
@@ -211,10 +276,22 @@ void QActive::postLIFO(QEvt const * const e) {
     // is it a dynamic event?
     if (e->poolId_ != static_cast<uint8_t>(0)) {
         QF_EVT_REF_CTR_INC_(e); // increment the reference counter
+#ifdef QF_EVT_LATENCY
+        // Gallium - added, static events may be in read-only memory
+        QF_EVT_CONST_CAST_(e)->stamp_ = QF_EVT_STAMP();
+#endif
     }
+#ifdef QF_COALESCE_MAX_SIG
+    // Gallium - added
+    // A LIFO post is never coalesced since it is meant to be urgent.
+    if (QF_isCoalesced_(e->sig)) {
+        m_coalescePend[QF_COALESCE_IDX_(e->sig)] |= QF_COALESCE_BIT_(e->sig);
+    }
+#endif
 
     --nFree;  // one free entry just used up
     m_eQueue.m_nFree = nFree; // update the volatile
+    QF_EQUEUE_POST_INC_(m_eQueue); // Gallium - added
     if (m_eQueue.m_nMin > nFree) {
         m_eQueue.m_nMin = nFree; // update minimum so far
     }
@@ -238,6 +315,160 @@ void QActive::postLIFO(QEvt const * const e) {
     QF_CRIT_EXIT_();
 }
 
+#ifdef QF_ACTIVE_CTRL_QUEUE
+// Gallium - added
+//****************************************************************************
+/// @description
+/// Posts an event to the control queue of the active object using the FIFO
+/// policy. Events in the control queue are always dispatched before any
+/// event in the regular event queue, so confirmations and self-posted
+/// notifications do not wait behind bulk data events. Unlike postLIFO(),
+/// the order among control events and among regular events is preserved.
+///
+/// @param[in]  e  pointer to the event to post to the control queue
+///
+/// @note The control queue must have been set up with setCtrlQueue().
+/// Like postLIFO(), delivery is guaranteed and an overflow asserts.
+///
+/// @sa QActive::postLIFO()
+///
+void QActive::postCtrl(QEvt const * const e) {
+    QF_CRIT_STAT_
+
+    QF_CRIT_ENTRY_();
+    QEQueueCtr nFree = m_ctrlQueue.m_nFree; // get volatile into temporary
+
+    // the control queue must be set up and able to accept the event
+    Q_ASSERT_ID(220, nFree != static_cast<QEQueueCtr>(0));
+
+    QS_BEGIN_NOCRIT_(QS_QF_ACTIVE_POST_FIFO, QS::priv_.aoObjFilter, this)
+        QS_TIME_();                      // timestamp
+        QS_OBJ_(this);                   // the sender object
+        QS_SIG_(e->sig);                 // the signal of the event
+        QS_OBJ_(this);                   // this active object
+        QS_2U8_(e->poolId_, e->refCtr_); // pool Id & refCtr of the evt
+        QS_EQC_(nFree);                  // number of free entries
+        QS_EQC_(m_ctrlQueue.m_nMin);     // min number of free entries
+    QS_END_NOCRIT_()
+
+    // is it a dynamic event?
+    if (e->poolId_ != static_cast<uint8_t>(0)) {
+        QF_EVT_REF_CTR_INC_(e); // increment the reference counter
+#ifdef QF_EVT_LATENCY
+        QF_EVT_CONST_CAST_(e)->stamp_ = QF_EVT_STAMP();
+#endif
+    }
+
+    // was the control queue empty? The AO is already ready to run if its
+    // regular queue is not empty.
+    if (m_ctrlQueue.insert_(e)
+        && (m_eQueue.m_frontEvt == static_cast<QEvt const *>(0)))
+    {
+        QACTIVE_EQUEUE_SIGNAL_(this); // signal the event queue
+    }
+    QF_CRIT_EXIT_();
+}
+#endif // QF_ACTIVE_CTRL_QUEUE
+
+#ifdef QF_ISR_POST_LOCKFREE
+// Gallium - added
+//****************************************************************************
+/// @description
+/// Posts an event from an ISR without disabling interrupts. An entry of the
+/// ISR inbox is reserved with an atomic increment bounded by both the inbox
+/// length and the free entries of m_eQueue (less @p margin). The ready-set
+/// is updated atomically as well. The AO moves the events to m_eQueue in
+/// order with drainIsrInbox_() before it touches m_eQueue.
+///
+/// A thread can only drain the inbox when no ISR is running, so a reserved
+/// entry is always written by then. m_eQueue.m_nFree is only changed by
+/// threads (and the locked ISR path), so it does not change during an ISR.
+///
+/// @note QS tracing is not available in this path. QF::gc() is still called
+/// when an event is rejected or coalesced. It is kept in the ISR rather than
+/// deferred to the AO, because the inbox may be full by then. Its critical
+/// sections are bounded: a reference counter decrement, or the push onto the
+/// free list of the pool (QMPool::put()). That is no longer than the
+/// QF::newX_() of the same event by the ISR.
+///
+bool QActive::postFromIsr_(QEvt const * const e, uint_fast16_t const margin) {
+#ifdef QF_COALESCE_MAX_SIG
+    // A racing ISR may miss the pending bit and post a duplicate, which is
+    // harmless for a coalesced signal.
+    bool const coalesced = QF_isCoalesced_(e->sig);
+    if (coalesced
+        && ((m_coalescePend[QF_COALESCE_IDX_(e->sig)]
+             & QF_COALESCE_BIT_(e->sig)) != static_cast<uint32_t>(0)))
+    {
+        if (e->poolId_ != static_cast<uint8_t>(0)) {
+            QF_atomicIncU8_(&QF_EVT_CONST_CAST_(e)->refCtr_); // for gc()
+        }
+        QF::gc(e); // bounded, see above
+        return true;
+    }
+#endif // QF_COALESCE_MAX_SIG
+
+    uint32_t const nFree = static_cast<uint32_t>(m_eQueue.m_nFree);
+    uint32_t limit = (nFree > static_cast<uint32_t>(margin))
+                     ? (nFree - static_cast<uint32_t>(margin))
+                     : static_cast<uint32_t>(0);
+    if (limit > m_isrLen) {
+        limit = m_isrLen;
+    }
+
+    uint32_t const idx = QF_atomicIncBelow_(&m_isrCount, limit);
+    if (idx >= limit) {
+        /// @note assert if event cannot be posted and dropping events is
+        /// not acceptable
+        Q_ASSERT_ID(130, margin != static_cast<uint_fast16_t>(0));
+#ifdef QF_EQUEUE_STATS
+        QF_atomicAdd_(&m_eQueue.m_nReject, static_cast<uint32_t>(1));
+#endif
+        QF::gc(e); // recycle the event to avoid a leak
+        return false;
+    }
+
+    // is it a dynamic event?
+    if (e->poolId_ != static_cast<uint8_t>(0)) {
+        QF_atomicIncU8_(&QF_EVT_CONST_CAST_(e)->refCtr_);
+#ifdef QF_EVT_LATENCY
+        QF_EVT_CONST_CAST_(e)->stamp_ = QF_EVT_STAMP();
+#endif
+    }
+    QF_PTR_AT_(m_isrSto, idx) = e;
+
+#ifdef QF_COALESCE_MAX_SIG
+    if (coalesced) {
+        (void)QF_atomicOr_(&m_coalescePend[QF_COALESCE_IDX_(e->sig)],
+                           QF_COALESCE_BIT_(e->sig));
+    }
+#endif
+    QACTIVE_EQUEUE_SIGNAL_ATOMIC_(this);
+    return true;
+}
+
+//****************************************************************************
+/// @description
+/// Moves the events of the ISR inbox to the back of m_eQueue, in the order
+/// they were posted. It must be called in a critical section, before any
+/// other access to m_eQueue. The AO is already in the ready-set.
+///
+void QActive::drainIsrInbox_(void) {
+    // only threads drain the inbox, see postLIFO()
+    Q_ASSERT_ID(150, !QF_ISR_CONTEXT_());
+
+    uint32_t const n = m_isrCount;
+    for (uint32_t i = static_cast<uint32_t>(0); i < n; ++i) {
+        // the room was reserved by postFromIsr_()
+        Q_ASSERT_ID(140, m_eQueue.m_nFree != static_cast<QEQueueCtr>(0));
+
+        // the AO is already in the ready-set
+        (void)m_eQueue.insert_(QF_PTR_AT_(m_isrSto, i));
+    }
+    m_isrCount = static_cast<uint32_t>(0);
+}
+#endif // QF_ISR_POST_LOCKFREE
+
 //****************************************************************************
 /// @description
 /// The behavior of this function depends on the kernel used in the QF port.
@@ -251,9 +482,59 @@ QEvt const *QActive::get_(void) {
     QF_CRIT_STAT_
     QF_CRIT_ENTRY_();
 
+#ifdef QF_ACTIVE_CTRL_QUEUE
+    // Gallium - added
+    // The control queue is always drained first.
+    if (m_ctrlQueue.m_frontEvt != static_cast<QEvt const *>(0)) {
+        QEvt const *e = m_ctrlQueue.m_frontEvt;
+        QEQueueCtr nFree = m_ctrlQueue.m_nFree + static_cast<QEQueueCtr>(1);
+        m_ctrlQueue.m_nFree = nFree; // upate the number of free
+
+        // any events in the ring buffer?
+        if (nFree <= m_ctrlQueue.m_end) {
+            // remove event from the tail
+            m_ctrlQueue.m_frontEvt =
+                QF_PTR_AT_(m_ctrlQueue.m_ring, m_ctrlQueue.m_tail);
+            if (m_ctrlQueue.m_tail == static_cast<QEQueueCtr>(0)) {
+                m_ctrlQueue.m_tail = m_ctrlQueue.m_end; // wrap around
+            }
+            --m_ctrlQueue.m_tail;
+        }
+        else {
+            // the control queue becomes empty
+            m_ctrlQueue.m_frontEvt = static_cast<QEvt const *>(0);
+        }
+
+        QS_BEGIN_NOCRIT_(QS_QF_ACTIVE_GET, QS::priv_.aoObjFilter, this)
+            QS_TIME_();                      // timestamp
+            QS_SIG_(e->sig);                 // the signal of this event
+            QS_OBJ_(this);                   // this active object
+            QS_2U8_(e->poolId_, e->refCtr_); // pool Id & refCtr of the evt
+            QS_EQC_(nFree);                  // number of free entries
+        QS_END_NOCRIT_()
+
+        QF_CRIT_EXIT_();
+        return e;
+    }
+#endif // QF_ACTIVE_CTRL_QUEUE
+
+#ifdef QF_ISR_POST_LOCKFREE
+    if (m_isrCount != static_cast<uint32_t>(0)) { // Gallium - added
+        drainIsrInbox_();
+    }
+#endif
+
     QACTIVE_EQUEUE_WAIT_(this); // wait for event to arrive directly
 
     QEvt const *e = m_eQueue.m_frontEvt; // always remove evt from the front
+#ifdef QF_COALESCE_MAX_SIG
+    // Gallium - added
+    // A coalesced signal posted from now on is queued again, since the
+    // handling of this instance may have already been done.
+    if (QF_isCoalesced_(e->sig)) {
+        m_coalescePend[QF_COALESCE_IDX_(e->sig)] &= ~QF_COALESCE_BIT_(e->sig);
+    }
+#endif
     QEQueueCtr nFree = m_eQueue.m_nFree + static_cast<QEQueueCtr>(1);
     m_eQueue.m_nFree = nFree; // upate the number of free
 
@@ -327,11 +608,9 @@ uint_fast16_t QF::getQueueMin(uint_fast8_t const prio) {
 
 //****************************************************************************
 QTicker::QTicker(uint8_t const tickRate)
-  : QActive(Q_STATE_CAST(0))
-{
-    // reuse m_head for tick-rate
-    m_eQueue.m_head = static_cast<QEQueueCtr>(tickRate);
-}
+  : QActive(Q_STATE_CAST(0)),
+    m_tickRate(tickRate) // Gallium - added
+{}
 //****************************************************************************
 void QTicker::init(QEvt const * const /*e*/) {
     m_eQueue.m_tail = static_cast<QEQueueCtr>(0);
@@ -345,7 +624,7 @@ void QTicker::dispatch(QEvt const * const /*e*/) {
     QF_CRIT_EXIT_();
 
     for (; n > static_cast<QEQueueCtr>(0); --n) {
-        QF::TICK_X(static_cast<uint8_t>(m_eQueue.m_head), this);
+        QF::TICK_X(m_tickRate, this); // Gallium - added
     }
 }
 //****************************************************************************
@@ -365,6 +644,9 @@ bool QTicker::post_(QEvt const * const /*e*/, uint_fast16_t const /*margin*/,
         static QEvt tickEvt(0);
         tickEvt.poolId_ = 0;
         tickEvt.refCtr_ = 0;
+#ifdef QF_EVT_LATENCY
+        tickEvt.stamp_ = QF_EVT_STAMP(); // Gallium - added
+#endif
 #else
         static QEvt const tickEvt = { static_cast<QSignal>(0),
                                       static_cast<uint8_t>(0),
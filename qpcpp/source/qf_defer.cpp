@@ -117,6 +117,122 @@ bool QActive::recall(QEQueue * const eq) {
     return recalled; // event not recalled
 }
 
+// Gallium - added
+//****************************************************************************
+/// @description
+/// Recalls all events deferred in @p eq in one pass. The recalled events are
+/// posted to the _front_ of the AO's queue in the order they were deferred,
+/// so a backlog of deferred requests is replayed back-to-back.
+///
+/// @param[in]  eq  pointer to a "raw" thread-safe queue to recall
+///                 events from.
+///
+/// @returns the number of events recalled.
+///
+/// @sa QP::QActive::recall(), QP::QActive::recallIf()
+///
+uint_fast16_t QActive::recallAll(QEQueue * const eq) {
+    return recallIf(eq, static_cast<RecallPred>(0), static_cast<void *>(0));
+}
+
+//****************************************************************************
+/// @description
+/// Recalls the events deferred in @p eq for which @p pred returns true, in
+/// one pass. The recalled events are posted to the _front_ of the AO's queue
+/// in the order they were deferred. The other events stay in @p eq in their
+/// original order.
+///
+/// @param[in]  eq    pointer to a "raw" thread-safe queue to recall
+///                   events from.
+/// @param[in]  pred  predicate selecting the events to recall, or NULL to
+///                   recall all events. It is called twice per event, so
+///                   it must not have side effects.
+/// @param[in]  arg   argument passed to @p pred.
+///
+/// @returns the number of events recalled.
+///
+/// @note Like recall(), this function must be called only by the AO owning
+/// the deferred queue @p eq, which therefore cannot change unexpectedly.
+///
+/// @sa QP::QActive::recall(), QP::QActive::recallSig()
+///
+uint_fast16_t QActive::recallIf(QEQueue * const eq, RecallPred const pred,
+                                void * const arg)
+{
+    uint_fast16_t const n = static_cast<uint_fast16_t>(eq->m_end)
+                            + static_cast<uint_fast16_t>(1)
+                            - static_cast<uint_fast16_t>(eq->m_nFree);
+    uint_fast16_t nRecalled = static_cast<uint_fast16_t>(0);
+    uint_fast16_t i;
+
+    // 1. post the matching events LIFO in reverse order, so that they end
+    //    up at the front of the AO's queue in their original order. The
+    //    i-th event (i > 0) is the (i - 1)-th one from the tail of the ring.
+    for (i = n; i > static_cast<uint_fast16_t>(0); --i) {
+        QEvt const *e;
+        if (i == static_cast<uint_fast16_t>(1)) {
+            e = eq->m_frontEvt;
+        }
+        else {
+            uint_fast16_t idx = static_cast<uint_fast16_t>(eq->m_tail)
+                                + static_cast<uint_fast16_t>(eq->m_end)
+                                + static_cast<uint_fast16_t>(2) - i;
+            if (idx >= static_cast<uint_fast16_t>(eq->m_end)) {
+                idx -= static_cast<uint_fast16_t>(eq->m_end);
+            }
+            e = QF_PTR_AT_(eq->m_ring, idx);
+        }
+        if ((pred == static_cast<RecallPred>(0)) || (*pred)(e, arg)) {
+            this->postLIFO(e); // post it to the _front_ of the AO's queue
+            ++nRecalled;
+        }
+    }
+
+    // 2. remove all events from the deferred queue, putting back the ones
+    //    not recalled.
+    for (i = static_cast<uint_fast16_t>(0); i < n; ++i) {
+        QEvt const * const e = eq->get();
+        bool const recalled = (pred == static_cast<RecallPred>(0))
+                              || (*pred)(e, arg);
+        if (!recalled) {
+            (void)eq->post(e, static_cast<uint_fast16_t>(0));
+        }
+
+        QF_CRIT_STAT_
+        QF_CRIT_ENTRY_();
+
+        // is it a dynamic event?
+        if (e->poolId_ != static_cast<uint8_t>(0)) {
+
+            // the event is referenced at least twice: once by the get()
+            // above (which did NOT decrement the reference counter) and
+            // once by either the AO's queue or the deferred queue again.
+            Q_ASSERT_ID(310, e->refCtr_ > static_cast<uint8_t>(1));
+
+            QF_EVT_REF_CTR_DEC_(e); // account for the get() above
+        }
+
+        QF_CRIT_EXIT_();
+    }
+    return nRecalled;
+}
+
+// predicate of recallSig(), @p arg points to the signal to match
+static bool recallSigPred(QEvt const * const e, void * const arg) {
+    return e->sig == *static_cast<QSignal const *>(arg);
+}
+
+//****************************************************************************
+/// @description
+/// Recalls the events with signal @p sig deferred in @p eq, in one pass.
+///
+/// @sa QP::QActive::recallIf()
+///
+uint_fast16_t QActive::recallSig(QEQueue * const eq, enum_t const sig) {
+    QSignal s = static_cast<QSignal>(sig);
+    return recallIf(eq, &recallSigPred, &s);
+}
+
 //****************************************************************************
 /// @description
 /// This function is part of the event deferral support. An active object
@@ -156,6 +156,9 @@ QEvt *QF::newX_(uint_fast16_t const evtSize,
                        idx + static_cast<uint_fast8_t>(1));
         // initialize the reference counter to 0
         e->refCtr_ = static_cast<uint8_t>(0);
+#ifdef QF_EVT_TRACKER
+        onEvtNew(e); // Gallium - added
+#endif // QF_EVT_TRACKER
     }
     else {
         // event was not allocated, assert that the caller provided non-zero
@@ -224,6 +227,10 @@ void QF::gc(QEvt const * const e) {
             // pool ID must be in range
             Q_ASSERT_ID(410, idx < QF_maxPool_);
 
+#ifdef QF_EVT_TRACKER
+            onEvtGc(e); // Gallium - added
+#endif // QF_EVT_TRACKER
+
 #ifdef Q_EVT_VIRTUAL
             // explicitly exectute the destructor'
             // NOTE: casting 'const' away is legitimate,
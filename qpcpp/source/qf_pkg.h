@@ -88,7 +88,16 @@ namespace QP {
 // package-scope objects -----------------------------------------------------
 extern QF_EPOOL_TYPE_ QF_pool_[QF_MAX_EPOOL]; //!< allocate event pools
 extern uint_fast8_t QF_maxPool_;     //!< # of initialized event pools
+#ifdef QF_SUBSCR_COMPACT
+// Gallium - added
+extern QSubscr *QF_subscrSto_;       //!< the double-buffered store
+extern QSubscr const *QF_subscr_;    //!< the sorted subscriptions in use
+extern uint_fast16_t QF_maxSubscr_;  //!< the size of each buffer
+extern uint_fast16_t QF_nSubscr_;    //!< the number of subscriptions
+extern uint_fast16_t QF_subscrGen_;  //!< incremented on every swap
+#else
 extern QSubscrList *QF_subscrList_;  //!< the subscriber list array
+#endif // QF_SUBSCR_COMPACT
 extern enum_t QF_maxPubSignal_;      //!< the maximum published signal
 
 //............................................................................
@@ -117,6 +126,37 @@ inline void QF_EVT_REF_CTR_DEC_(QEvt const * const e) {
     --(QF_EVT_CONST_CAST_(e))->refCtr_;
 }
 
+#ifdef QF_COALESCE_MAX_SIG
+// Gallium - added
+extern uint32_t QF_coalesceSig_[QF_COALESCE_MAX_SIG / 32]; //!< coalesced sigs
+
+//! index of the word holding the bit of signal @p sig_ in a coalesce mask
+#define QF_COALESCE_IDX_(sig_)  (static_cast<uint_fast16_t>(sig_) >> 5)
+
+//! bit of signal @p sig_ in a coalesce mask
+#define QF_COALESCE_BIT_(sig_) \
+    (static_cast<uint32_t>(1) << (static_cast<uint_fast16_t>(sig_) & 0x1FU))
+
+//! test if signal @p sig is coalesced
+inline bool QF_isCoalesced_(QSignal const sig) {
+    return (sig < static_cast<QSignal>(QF_COALESCE_MAX_SIG))
+           && ((QF_coalesceSig_[QF_COALESCE_IDX_(sig)] & QF_COALESCE_BIT_(sig))
+               != static_cast<uint32_t>(0));
+}
+#endif // QF_COALESCE_MAX_SIG
+
+// Gallium - added
+#ifdef QF_EQUEUE_STATS
+    //! account for one event posted to the native queue @p q_
+    #define QF_EQUEUE_POST_INC_(q_)     (++(q_).m_nPost)
+
+    //! account for one post rejected by the native queue @p q_
+    #define QF_EQUEUE_REJECT_INC_(q_)   (++(q_).m_nReject)
+#else
+    #define QF_EQUEUE_POST_INC_(q_)     ((void)0)
+    #define QF_EQUEUE_REJECT_INC_(q_)   ((void)0)
+#endif // QF_EQUEUE_STATS
+
 //! macro to test that a pointer @p x_ is in range between @p min_ and @p max_
 /// @description
 /// This macro is specifically and exclusively used for checking the range
@@ -132,6 +172,42 @@ inline void QF_EVT_REF_CTR_DEC_(QEvt const * const e) {
 //! access element at index @p i_ from the base pointer @p base_
 #define QF_PTR_AT_(base_, i_) (base_[i_])
 
+namespace QP {
+
+// Gallium - added
+//! Inserts @p e at the back of the queue (FIFO) and updates the free count,
+//! the low-watermark and the post count. The caller must have checked that
+//! the queue is not full, accounted for the reference of @p e and entered
+//! a critical section. Returns true if the queue was empty, i.e. @p e became
+//! the front event and the owner of the queue needs to be signaled.
+inline bool QEQueue::insert_(QEvt const * const e) {
+    QEQueueCtr nFree = m_nFree; // get volatile into temporary
+    --nFree;  // one free entry just used up
+    m_nFree = nFree; // update the volatile
+    QF_EQUEUE_POST_INC_(*this);
+    if (m_nMin > nFree) {
+        m_nMin = nFree; // update minimum so far
+    }
+
+    // is the queue empty?
+    if (m_frontEvt == static_cast<QEvt const *>(0)) {
+        m_frontEvt = e; // deliver event directly
+        return true;
+    }
+
+    // queue is not empty, insert event into the ring-buffer
+    QF_PTR_AT_(m_ring, m_head) = e;
+
+    // need to wrap head?
+    if (m_head == static_cast<QEQueueCtr>(0)) {
+        m_head = m_end; // wrap around
+    }
+    --m_head;
+    return false;
+}
+
+} // namespace QP
+
 //****************************************************************************
 #ifdef Q_SPY  // QS software tracing enabled?
 
@@ -53,7 +53,60 @@ namespace QP {
 Q_DEFINE_THIS_MODULE("qf_ps")
 
 // Package-scope objects *****************************************************
+#ifdef QF_SUBSCR_COMPACT
+// Gallium - added
+QSubscr *QF_subscrSto_;
+QSubscr const *QF_subscr_;
+uint_fast16_t QF_maxSubscr_;
+uint_fast16_t QF_nSubscr_;
+uint_fast16_t QF_subscrGen_;
+
+// the prio bits must hold any prio up to QF_MAX_ACTIVE
+Q_ASSERT_COMPILE(QF_MAX_ACTIVE <= QF_SUBSCR_PRIO_MASK);
+
+//! Returns the index of the first of the @p n subscriptions in @p subscr
+/// not less than @p key.
+static uint_fast16_t QF_subscrFind_(QSubscr const * const subscr,
+                                    uint_fast16_t const n,
+                                    QSubscr const key)
+{
+    uint_fast16_t lo = static_cast<uint_fast16_t>(0);
+    uint_fast16_t hi = n;
+    while (lo < hi) {
+        uint_fast16_t mid = (lo + hi) >> 1;
+        if (QF_PTR_AT_(subscr, mid) < key) {
+            lo = mid + static_cast<uint_fast16_t>(1);
+        }
+        else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+//! Returns the half of the double-buffered store not in use by publishers.
+/// Must be called with the scheduler locked by QF_subscrUpdateBegin_().
+static QSubscr *QF_subscrSpare_(void) {
+    return (QF_subscr_ == QF_subscrSto_)
+           ? &QF_subscrSto_[QF_maxSubscr_]
+           : QF_subscrSto_;
+}
+
+//! Makes the @p n subscriptions in @p subscr the ones seen by publishers.
+/// The critical section only covers the switch of the buffers.
+static void QF_subscrSwap_(QSubscr const * const subscr,
+                           uint_fast16_t const n)
+{
+    QF_CRIT_STAT_
+    QF_CRIT_ENTRY_();
+    QF_subscr_  = subscr;
+    QF_nSubscr_ = n;
+    ++QF_subscrGen_; // a publisher walking the old buffer starts over
+    QF_CRIT_EXIT_();
+}
+#else
 QSubscrList *QF_subscrList_;
+#endif // QF_SUBSCR_COMPACT
 enum_t QF_maxPubSignal_;
 
 //****************************************************************************
@@ -83,6 +136,31 @@ enum_t QF_maxPubSignal_;
 /// The following example shows the typical initialization sequence of QF:
 /// @include qf_main.cpp
 ///
+#ifdef QF_SUBSCR_COMPACT
+// Gallium - added
+/// @param[in] subscrSto pointer to the array of subscriptions, which must
+///                      hold 2 * @p maxSubscr entries. It is double-buffered,
+///                      so that publishers read one half while a
+///                      subscription change is written to the other.
+/// @param[in] maxSubscr the maximum number of subscriptions of all active
+///                      objects.
+/// @param[in] maxSignal the maximum signal that can be published or
+///                      subscribed.
+void QF::psInit(QSubscr * const subscrSto, uint_fast16_t const maxSubscr,
+                enum_t const maxSignal)
+{
+    /// @pre the signal must fit in the upper bits of a subscription
+    Q_REQUIRE_ID(150, static_cast<uint_fast32_t>(maxSignal)
+        <= (static_cast<uint_fast32_t>(0x10000) >> QF_SUBSCR_PRIO_BITS));
+
+    QF_subscrSto_    = subscrSto;
+    QF_subscr_       = subscrSto;
+    QF_maxSubscr_    = maxSubscr;
+    QF_nSubscr_      = static_cast<uint_fast16_t>(0);
+    QF_subscrGen_    = static_cast<uint_fast16_t>(0);
+    QF_maxPubSignal_ = maxSignal;
+}
+#else
 void QF::psInit(QSubscrList * const subscrSto, enum_t const maxSignal) {
     QF_subscrList_   = subscrSto;
     QF_maxPubSignal_ = maxSignal;
@@ -94,6 +172,7 @@ void QF::psInit(QSubscrList * const subscrSto, enum_t const maxSignal) {
              static_cast<uint_fast16_t>(static_cast<uint_fast16_t>(maxSignal)
               * static_cast<uint_fast16_t>(sizeof(QSubscrList))));
 }
+#endif // QF_SUBSCR_COMPACT
 
 //****************************************************************************
 /// @description
@@ -144,10 +223,52 @@ void QF::publish_(QEvt const * const e, void const * const sender) {
     }
 
     // make a local, modifiable copy of the subscriber list
+#ifdef QF_SUBSCR_COMPACT
+    // Gallium - added
+    // The subscriptions are searched outside of the critical section. A
+    // thread changing them meanwhile swaps the buffers, which is detected by
+    // the generation count, and the search is repeated. ISRs do not change
+    // subscriptions, so the search from an ISR never repeats.
+    QPSet subscrList;
+    QSubscr const key = QF_SUBSCR_KEY(e->sig, 0);
+    for (;;) {
+        QSubscr const * const subscr = QF_subscr_;
+        uint_fast16_t const n = QF_nSubscr_;
+        uint_fast16_t const gen = QF_subscrGen_;
+        QF_CRIT_EXIT_();
+
+        subscrList.setEmpty();
+        for (uint_fast16_t i = QF_subscrFind_(subscr, n, key);
+             (i < n)
+             && ((QF_PTR_AT_(subscr, i) & ~QF_SUBSCR_PRIO_MASK) == key);
+             ++i)
+        {
+            subscrList.insert(static_cast<uint_fast8_t>(
+                QF_PTR_AT_(subscr, i) & QF_SUBSCR_PRIO_MASK));
+        }
+
+        QF_CRIT_ENTRY_();
+        if (gen == QF_subscrGen_) {
+            break;
+        }
+    }
+    QF_CRIT_EXIT_();
+#else
     QPSet subscrList = QF_PTR_AT_(QF_subscrList_, e->sig);
     QF_CRIT_EXIT_();
-
-    if (subscrList.notEmpty()) {
+#endif // QF_SUBSCR_COMPACT
+
+    // Gallium - added
+    // Fast path for the common case of a single subscriber. Locking the
+    // scheduler only preserves the order of posting among multiple
+    // subscribers, so it is not needed here. The event is protected from
+    // premature recycling by the reference counter incremented above.
+    if (subscrList.hasOneElement()) {
+        uint_fast8_t p = subscrList.findMax();
+        Q_ASSERT_ID(205, active_[p] != static_cast<QActive *>(0));
+        (void)active_[p]->POST(e, sender);
+    }
+    else if (subscrList.notEmpty()) {
         uint_fast8_t p = subscrList.findMax(); // the highest-prio subscriber
         QF_SCHED_STAT_
 
@@ -202,6 +323,46 @@ void QActive::subscribe(enum_t const sig) const {
               && (p <= static_cast<uint_fast8_t>(QF_MAX_ACTIVE))
               && (QF::active_[p] == this));
 
+#ifdef QF_SUBSCR_COMPACT
+    // Gallium - added
+    // The new array is built in the spare buffer outside of any critical
+    // section. The scheduler lock keeps other threads from changing the
+    // subscriptions meanwhile. Copying is O(n), but subscriptions are rare
+    // compared to publishing.
+    /// @pre subscriptions cannot be changed from an ISR
+    Q_REQUIRE_ID(305, !QXK_ISR_CONTEXT_());
+
+    QF_SCHED_STAT_
+    QF_SCHED_LOCK_(static_cast<uint_fast8_t>(QF_MAX_ACTIVE));
+
+    QSubscr const * const subscr = QF_subscr_;
+    uint_fast16_t const n = QF_nSubscr_;
+    QSubscr const key = QF_SUBSCR_KEY(sig, p);
+    uint_fast16_t const i = QF_subscrFind_(subscr, n, key);
+    if ((i == n) || (QF_PTR_AT_(subscr, i) != key)) {
+        // the subscription array must not overflow
+        Q_ASSERT_ID(310, n < QF_maxSubscr_);
+
+        QSubscr * const spare = QF_subscrSpare_();
+        uint_fast16_t j;
+        for (j = static_cast<uint_fast16_t>(0); j < i; ++j) {
+            QF_PTR_AT_(spare, j) = QF_PTR_AT_(subscr, j);
+        }
+        QF_PTR_AT_(spare, i) = key;
+        for (; j < n; ++j) {
+            QF_PTR_AT_(spare, j + 1U) = QF_PTR_AT_(subscr, j);
+        }
+        QF_subscrSwap_(spare, n + 1U);
+    }
+
+    QS_BEGIN_(QS_QF_ACTIVE_SUBSCRIBE, QS::priv_.aoObjFilter, this)
+        QS_TIME_();    // timestamp
+        QS_SIG_(sig);  // the signal of this event
+        QS_OBJ_(this); // this active object
+    QS_END_()
+
+    QF_SCHED_UNLOCK_();
+#else
     QF_CRIT_STAT_
     QF_CRIT_ENTRY_();
 
@@ -213,6 +374,7 @@ void QActive::subscribe(enum_t const sig) const {
 
     QF_PTR_AT_(QF_subscrList_, sig).insert(p); // insert into subscriber-list
     QF_CRIT_EXIT_();
+#endif // QF_SUBSCR_COMPACT
 }
 
 //****************************************************************************
@@ -243,6 +405,39 @@ void QActive::unsubscribe(enum_t const sig) const {
                       && (p <= static_cast<uint_fast8_t>(QF_MAX_ACTIVE))
                       && (QF::active_[p] == this));
 
+#ifdef QF_SUBSCR_COMPACT
+    // Gallium - added
+    // See QActive::subscribe().
+    /// @pre subscriptions cannot be changed from an ISR
+    Q_REQUIRE_ID(405, !QXK_ISR_CONTEXT_());
+
+    QF_SCHED_STAT_
+    QF_SCHED_LOCK_(static_cast<uint_fast8_t>(QF_MAX_ACTIVE));
+
+    QSubscr const * const subscr = QF_subscr_;
+    uint_fast16_t const n = QF_nSubscr_;
+    QSubscr const key = QF_SUBSCR_KEY(sig, p);
+    uint_fast16_t const i = QF_subscrFind_(subscr, n, key);
+    if ((i < n) && (QF_PTR_AT_(subscr, i) == key)) {
+        QSubscr * const spare = QF_subscrSpare_();
+        uint_fast16_t j;
+        for (j = static_cast<uint_fast16_t>(0); j < i; ++j) {
+            QF_PTR_AT_(spare, j) = QF_PTR_AT_(subscr, j);
+        }
+        for (++j; j < n; ++j) {
+            QF_PTR_AT_(spare, j - 1U) = QF_PTR_AT_(subscr, j);
+        }
+        QF_subscrSwap_(spare, n - 1U);
+    }
+
+    QS_BEGIN_(QS_QF_ACTIVE_UNSUBSCRIBE, QS::priv_.aoObjFilter, this)
+        QS_TIME_();         // timestamp
+        QS_SIG_(sig);       // the signal of this event
+        QS_OBJ_(this);      // this active object
+    QS_END_()
+
+    QF_SCHED_UNLOCK_();
+#else
     QF_CRIT_STAT_
     QF_CRIT_ENTRY_();
 
@@ -255,6 +450,7 @@ void QActive::unsubscribe(enum_t const sig) const {
     QF_PTR_AT_(QF_subscrList_,sig).remove(p);  // remove from subscriber-list
 
     QF_CRIT_EXIT_();
+#endif // QF_SUBSCR_COMPACT
 }
 
 //****************************************************************************
@@ -283,6 +479,42 @@ void QActive::unsubscribeAll(void) const {
                       && (p <= static_cast<uint_fast8_t>(QF_MAX_ACTIVE))
                       && (QF::active_[p] == this));
 
+#ifdef QF_SUBSCR_COMPACT
+    // Gallium - added
+    // Copy the subscriptions of other AOs to the spare buffer.
+    // See QActive::subscribe().
+    /// @pre subscriptions cannot be changed from an ISR
+    Q_REQUIRE_ID(505, !QXK_ISR_CONTEXT_());
+
+    QF_SCHED_STAT_
+    QF_SCHED_LOCK_(static_cast<uint_fast8_t>(QF_MAX_ACTIVE));
+
+    QSubscr const * const subscr = QF_subscr_;
+    uint_fast16_t const n = QF_nSubscr_;
+    QSubscr * const spare = QF_subscrSpare_();
+    uint_fast16_t j = static_cast<uint_fast16_t>(0);
+    for (uint_fast16_t i = static_cast<uint_fast16_t>(0); i < n; ++i) {
+        QSubscr const s = QF_PTR_AT_(subscr, i);
+        if ((s & QF_SUBSCR_PRIO_MASK) == p) {
+            QS_BEGIN_(QS_QF_ACTIVE_UNSUBSCRIBE,
+                      QS::priv_.aoObjFilter, this)
+                QS_TIME_();     // timestamp
+                QS_SIG_(static_cast<QSignal>(
+                    s >> QF_SUBSCR_PRIO_BITS)); // the signal
+                QS_OBJ_(this);  // this active object
+            QS_END_()
+        }
+        else {
+            QF_PTR_AT_(spare, j) = s;
+            ++j;
+        }
+    }
+    if (j != n) {
+        QF_subscrSwap_(spare, j);
+    }
+
+    QF_SCHED_UNLOCK_();
+#else
     for (enum_t sig = Q_USER_SIG; sig < QF_maxPubSignal_; ++sig) {
         QF_CRIT_STAT_
         QF_CRIT_ENTRY_();
@@ -299,6 +531,32 @@ void QActive::unsubscribeAll(void) const {
         }
         QF_CRIT_EXIT_();
     }
+#endif // QF_SUBSCR_COMPACT
+}
+
+//****************************************************************************
+// Gallium - added
+/// @description
+/// Tells if any active object subscribes to @p sig, e.g. to check at startup
+/// that a signal posted directly to its owner is not expected by others.
+///
+/// @param[in] sig event signal to check
+///
+bool QF::hasSubscriber(enum_t const sig) {
+    Q_REQUIRE_ID(600, (Q_USER_SIG <= sig) && (sig < QF_maxPubSignal_));
+
+    QF_CRIT_STAT_
+    QF_CRIT_ENTRY_();
+#ifdef QF_SUBSCR_COMPACT
+    QSubscr const key = QF_SUBSCR_KEY(sig, 0);
+    uint_fast16_t const i = QF_subscrFind_(QF_subscr_, QF_nSubscr_, key);
+    bool const found = (i < QF_nSubscr_)
+        && ((QF_PTR_AT_(QF_subscr_, i) & ~QF_SUBSCR_PRIO_MASK) == key);
+#else
+    bool const found = QF_PTR_AT_(QF_subscrList_, sig).notEmpty();
+#endif // QF_SUBSCR_COMPACT
+    QF_CRIT_EXIT_();
+    return found;
 }
 
 } // namespace QP
@@ -43,7 +43,8 @@ namespace QP {
 //****************************************************************************
 QActive::QActive(QStateHandler const initial)
   : QHsm(initial),
-    m_prio(static_cast<uint_fast8_t>(0))
+    m_prio(static_cast<uint_fast8_t>(0)),
+    m_burst(static_cast<uint_fast8_t>(1)) // Gallium - added
 {
     m_state.fun = Q_STATE_CAST(&QHsm::top);
 
@@ -54,6 +55,19 @@ QActive::QActive(QStateHandler const initial)
 #ifdef QF_THREAD_TYPE
     QF::bzero(&m_thread, static_cast<uint_fast16_t>(sizeof(m_thread)));
 #endif
+
+#ifdef QF_COALESCE_MAX_SIG
+    // Gallium - added
+    QF::bzero(&m_coalescePend[0],
+              static_cast<uint_fast16_t>(sizeof(m_coalescePend)));
+#endif
+
+#ifdef QF_ISR_POST_LOCKFREE
+    // Gallium - added
+    m_isrSto   = static_cast<QEvt const **>(0);
+    m_isrCount = static_cast<uint32_t>(0);
+    m_isrLen   = static_cast<uint32_t>(0);
+#endif
 }
 
 } // namespace QP
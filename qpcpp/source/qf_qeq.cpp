@@ -63,7 +63,12 @@ QEQueue::QEQueue(void)
     m_tail(static_cast<QEQueueCtr>(0)),
     m_nFree(static_cast<QEQueueCtr>(0)),
     m_nMin(static_cast<QEQueueCtr>(0))
-{}
+{
+#ifdef QF_EQUEUE_STATS
+    m_nPost   = static_cast<uint32_t>(0); // Gallium - added
+    m_nReject = static_cast<uint32_t>(0);
+#endif
+}
 
 //****************************************************************************
 /// @description
@@ -91,6 +96,10 @@ void QEQueue::init(QEvt const *qSto[], uint_fast16_t const qLen) {
     m_nFree    = static_cast<QEQueueCtr>(
                  qLen + static_cast<uint_fast16_t>(1)); //+1 for frontEvt
     m_nMin     = m_nFree;
+#ifdef QF_EQUEUE_STATS
+    m_nPost    = static_cast<uint32_t>(0); // Gallium - added
+    m_nReject  = static_cast<uint32_t>(0);
+#endif
 
     QS_CRIT_STAT_
     QS_BEGIN_(QS_QF_EQUEUE_INIT, QS::priv_.eqObjFilter, this)
@@ -148,6 +157,7 @@ bool QEQueue::post(QEvt const * const e, uint_fast16_t const margin) {
 
         --nFree; // one free entry just used up
         m_nFree = nFree; // update the volatile
+        QF_EQUEUE_POST_INC_(*this); // Gallium - added
         if (m_nMin > nFree) {
             m_nMin = nFree; // update minimum so far
         }
@@ -174,6 +184,7 @@ bool QEQueue::post(QEvt const * const e, uint_fast16_t const margin) {
         /// the event. This is to support the "guaranteed event delivery"
         /// policy for most events posted within the framework.
         Q_ASSERT_ID(210, margin != static_cast<uint_fast16_t>(0));
+        QF_EQUEUE_REJECT_INC_(*this); // Gallium - added
 
         QS_BEGIN_NOCRIT_(QS_QF_EQUEUE_POST_ATTEMPT, QS::priv_.eqObjFilter,
                          this)
@@ -234,6 +245,7 @@ void QEQueue::postLIFO(QEvt const * const e) {
 
     --nFree; // one free entry just used up
     m_nFree = nFree; // update the volatile
+    QF_EQUEUE_POST_INC_(*this); // Gallium - added
     if (m_nMin > nFree) {
         m_nMin = nFree; // update minimum so far
     }
@@ -52,7 +52,12 @@ namespace QP {
 Q_DEFINE_THIS_MODULE("qf_time")
 
 // Package-scope objects *****************************************************
+#ifdef QF_TIMEEVT_WHEEL
+// Gallium - added
+QTimeWheel QF::timeWheel_[QF_MAX_TICK_RATE]; // timing wheels
+#else
 QTimeEvt QF::timeEvtHead_[QF_MAX_TICK_RATE]; // heads of time event lists
+#endif // QF_TIMEEVT_WHEEL
 
 //****************************************************************************
 /// @description
@@ -70,6 +75,184 @@ QTimeEvt QF::timeEvtHead_[QF_MAX_TICK_RATE]; // heads of time event lists
 ///
 /// @sa QP::QTimeEvt.
 ///
+#ifdef QF_TIMEEVT_WHEEL
+// Gallium - added
+#ifndef Q_SPY
+void QF::tickX_(uint8_t const tickRate)
+#else
+void QF::tickX_(uint8_t const tickRate, void const * const sender)
+#endif
+{
+    QTimeWheel &w = timeWheel_[tickRate];
+    QF_CRIT_STAT_
+
+    QF_CRIT_ENTRY_();
+    QTimeEvtCtr now = static_cast<QTimeEvtCtr>(w.m_now + 1U);
+    w.m_now = now;
+
+    QS_BEGIN_NOCRIT_(QS_QF_TICK, static_cast<void*>(0), static_cast<void*>(0))
+        QS_TEC_(now);     // tick ctr
+        QS_U8_(tickRate); // tick rate
+    QS_END_NOCRIT_()
+
+    // cascade the levels whose lower level wrapped around, lowest first,
+    // so that time events expiring right now end up in the level-0 slot
+    for (uint_fast8_t lvl = static_cast<uint_fast8_t>(1);
+         lvl < static_cast<uint_fast8_t>(QF_TIMEEVT_WHEEL_LEVELS);
+         ++lvl)
+    {
+        uint_fast8_t shift = lvl * static_cast<uint_fast8_t>(
+                                       QF_TIMEEVT_WHEEL_BITS);
+        if ((now & ((static_cast<QTimeEvtCtr>(1) << shift) - 1U)) != 0U) {
+            break;
+        }
+
+        // detach the slot, so that time events armed or disarmed while the
+        // critical section is exited below never touch a stale list
+        QTimeEvt * volatile *slot = &w.m_slot[lvl]
+            [(now >> shift) & (QF_TIMEEVT_WHEEL_SLOTS - 1U)];
+        w.m_pend = *slot;
+        *slot = static_cast<QTimeEvt *>(0);
+        if (w.m_pend != static_cast<QTimeEvt *>(0)) {
+            w.m_pend->m_pprev = &w.m_pend;
+        }
+
+        while (w.m_pend != static_cast<QTimeEvt *>(0)) {
+            QTimeEvt *t = w.m_pend;
+            t->unlink_();
+            t->link_(static_cast<QTimeEvtCtr>(t->m_expiry - now));
+            QF_CRIT_EXIT_(); // exit crit. section to reduce latency
+
+            // prevent merging critical sections, see NOTE1 below
+            QF_CRIT_EXIT_NOP();
+            QF_CRIT_ENTRY_();
+        }
+    }
+
+    // all time events in the current level-0 slot expire now
+    QTimeEvt * volatile *slot = &w.m_slot[0]
+        [now & (QF_TIMEEVT_WHEEL_SLOTS - 1U)];
+    w.m_pend = *slot;
+    *slot = static_cast<QTimeEvt *>(0);
+    if (w.m_pend != static_cast<QTimeEvt *>(0)) {
+        w.m_pend->m_pprev = &w.m_pend;
+        ++w.m_nExpiryTicks;
+    }
+
+    while (w.m_pend != static_cast<QTimeEvt *>(0)) {
+        QTimeEvt *t = w.m_pend;
+        QActive *act = t->toActive(); // temporary for volatile
+        t->unlink_();
+        ++w.m_nExpired;
+
+        // periodic time evt?
+        if (t->m_interval != static_cast<QTimeEvtCtr>(0)) {
+            t->m_ctr = t->m_interval; // rearm the time event
+            // keep the period relative to the nominal expiry, so that the
+            // slack never accumulates
+            t->linkSlack_(static_cast<QTimeEvtCtr>(
+                              t->m_nominal + t->m_interval - now));
+        }
+        // one-shot time event: automatically disarm
+        else {
+            t->m_ctr = static_cast<QTimeEvtCtr>(0);
+
+            QS_BEGIN_NOCRIT_(QS_QF_TIMEEVT_AUTO_DISARM,
+                             QS::priv_.teObjFilter, t)
+                QS_OBJ_(t);        // this time event object
+                QS_OBJ_(act);      // the target AO
+                QS_U8_(tickRate);  // tick rate
+            QS_END_NOCRIT_()
+        }
+
+        QS_BEGIN_NOCRIT_(QS_QF_TIMEEVT_POST, QS::priv_.teObjFilter, t)
+            QS_TIME_();            // timestamp
+            QS_OBJ_(t);            // the time event object
+            QS_SIG_(t->sig);       // signal of this time event
+            QS_OBJ_(act);          // the target AO
+            QS_U8_(tickRate);      // tick rate
+        QS_END_NOCRIT_()
+
+        QF_CRIT_EXIT_(); // exit crit. section before posting
+
+        (void)act->POST(t, sender); // asserts if queue overflows
+
+        QF_CRIT_ENTRY_(); // re-enter crit. section to continue
+    }
+    QF_CRIT_EXIT_();
+}
+
+//****************************************************************************
+/// @description
+/// Links the time event into the slot of its expiry tick, in the lowest
+/// level of the timing wheel spanning @p nTicks.
+///
+/// @note must be called from within a critical section
+///
+void QTimeEvt::link_(QTimeEvtCtr const nTicks) {
+    QTimeWheel &w = QF::timeWheel_[refCtr_ & static_cast<uint8_t>(0x7F)];
+    QTimeEvtCtr expiry = static_cast<QTimeEvtCtr>(w.m_now + nTicks);
+    uint_fast8_t shift = static_cast<uint_fast8_t>(0);
+    while ((shift < static_cast<uint_fast8_t>((QF_TIMEEVT_WHEEL_LEVELS - 1)
+                                              * QF_TIMEEVT_WHEEL_BITS))
+           && ((nTicks >> (shift + QF_TIMEEVT_WHEEL_BITS)) != 0U))
+    {
+        shift += static_cast<uint_fast8_t>(QF_TIMEEVT_WHEEL_BITS);
+    }
+    QTimeEvt * volatile *slot =
+        &w.m_slot[shift / static_cast<uint_fast8_t>(QF_TIMEEVT_WHEEL_BITS)]
+                 [(expiry >> shift) & (QF_TIMEEVT_WHEEL_SLOTS - 1U)];
+
+    m_expiry = expiry;
+    m_next = *slot;
+    if (m_next != static_cast<QTimeEvt *>(0)) {
+        m_next->m_pprev = &m_next;
+    }
+    m_pprev = slot;
+    *slot = this;
+    refCtr_ |= static_cast<uint8_t>(0x80); // mark as linked
+    ++w.m_nArmed;
+}
+
+//****************************************************************************
+/// @description
+/// Of the ticks in [now + @p nTicks, now + @p nTicks + m_slack], picks the
+/// one with the most trailing zero bits. Time events with overlapping
+/// windows thus tend to expire on the same tick, without having to look
+/// at each other.
+///
+/// @note must be called from within a critical section
+///
+void QTimeEvt::linkSlack_(QTimeEvtCtr const nTicks) {
+    QTimeEvtCtr now = QF::timeWheel_[refCtr_ & static_cast<uint8_t>(0x7F)]
+                          .m_now;
+    m_nominal = static_cast<QTimeEvtCtr>(now + nTicks);
+    QTimeEvtCtr expiry = static_cast<QTimeEvtCtr>(m_nominal + m_slack);
+    QTimeEvtCtr diff = static_cast<QTimeEvtCtr>(m_nominal ^ expiry);
+    if (diff != static_cast<QTimeEvtCtr>(0)) {
+        // clear all bits below the highest bit that differs
+        expiry &= static_cast<QTimeEvtCtr>(
+            ~((static_cast<uint32_t>(1) << (QF_LOG2(diff) - 1U)) - 1U));
+    }
+    link_(static_cast<QTimeEvtCtr>(expiry - now));
+}
+
+//****************************************************************************
+/// @note must be called from within a critical section
+///
+void QTimeEvt::unlink_(void) {
+    QTimeEvt *next = m_next;
+    *m_pprev = next;
+    if (next != static_cast<QTimeEvt *>(0)) {
+        next->m_pprev = m_pprev;
+    }
+    m_next = static_cast<QTimeEvt *>(0);
+    m_pprev = static_cast<QTimeEvt * volatile *>(0);
+    refCtr_ &= static_cast<uint8_t>(0x7F); // mark as unlinked
+    --QF::timeWheel_[refCtr_].m_nArmed;
+}
+
+#else // QF_TIMEEVT_WHEEL
 #ifndef Q_SPY
 void QF::tickX_(uint8_t const tickRate)
 #else
@@ -169,6 +352,7 @@ void QF::tickX_(uint8_t const tickRate, void const * const sender)
     }
     QF_CRIT_EXIT_();
 }
+#endif // QF_TIMEEVT_WHEEL
 
 //****************************************************************************
 // NOTE1:
@@ -198,6 +382,11 @@ bool QF::noTimeEvtsActiveX(uint8_t const tickRate) {
     Q_REQUIRE_ID(200, tickRate < static_cast<uint8_t>(QF_MAX_TICK_RATE));
 
     bool inactive;
+#ifdef QF_TIMEEVT_WHEEL
+    // Gallium - added
+    inactive = (timeWheel_[tickRate].m_nArmed
+                == static_cast<uint_fast16_t>(0));
+#else
     if (timeEvtHead_[tickRate].m_next == static_cast<QTimeEvt *>(0)) {
         inactive = false;
     }
@@ -207,6 +396,7 @@ bool QF::noTimeEvtsActiveX(uint8_t const tickRate) {
     else {
         inactive = true;
     }
+#endif // QF_TIMEEVT_WHEEL
     return inactive;
 }
 
@@ -252,6 +442,13 @@ QTimeEvt::QTimeEvt(QActive * const act,
     // is 0 for time events unlinked from any list and 1 otherwise.
     //
     refCtr_ = tickRate;
+#ifdef QF_TIMEEVT_WHEEL
+    // Gallium - added
+    m_pprev   = static_cast<QTimeEvt * volatile *>(0);
+    m_expiry  = static_cast<QTimeEvtCtr>(0);
+    m_nominal = static_cast<QTimeEvtCtr>(0);
+    m_slack   = static_cast<QTimeEvtCtr>(0);
+#endif // QF_TIMEEVT_WHEEL
 }
 
 //****************************************************************************
@@ -285,6 +482,13 @@ QTimeEvt::QTimeEvt()
     // is 0 for time events unlinked from any list and 1 otherwise.
     //
     refCtr_ = static_cast<uint8_t>(0); // default rate 0
+#ifdef QF_TIMEEVT_WHEEL
+    // Gallium - added
+    m_pprev   = static_cast<QTimeEvt * volatile *>(0);
+    m_expiry  = static_cast<QTimeEvtCtr>(0);
+    m_nominal = static_cast<QTimeEvtCtr>(0);
+    m_slack   = static_cast<QTimeEvtCtr>(0);
+#endif // QF_TIMEEVT_WHEEL
 }
 
 //****************************************************************************
@@ -297,6 +501,11 @@ QTimeEvt::QTimeEvt()
 /// @param[in] nTicks   number of clock ticks (at the associated rate)
 ///                     to rearm the time event with.
 /// @param[in] interval interval (in clock ticks) for periodic time event.
+/// @param[in] slack    Gallium - number of clock ticks every expiration may
+///                     be delayed by, so that time events of different AOs
+///                     coalesce on fewer ticks. It must be less than
+///                     @p interval of a periodic time event, and it is
+///                     ignored unless #QF_TIMEEVT_WHEEL is defined.
 ///
 /// @note After posting, a one-shot time event gets automatically disarmed
 /// while a periodic time event (interval != 0) is automatically re-armed.
@@ -311,7 +520,9 @@ QTimeEvt::QTimeEvt()
 /// machine of an active object:
 /// @include qf_state.cpp
 ///
-void QTimeEvt::armX(QTimeEvtCtr const nTicks, QTimeEvtCtr const interval) {
+void QTimeEvt::armX(QTimeEvtCtr const nTicks, QTimeEvtCtr const interval,
+                    QTimeEvtCtr const slack)
+{
     uint_fast8_t tickRate = static_cast<uint_fast8_t>(refCtr_)
                             & static_cast<uint_fast8_t>(0x7F);
     QTimeEvtCtr cntr = m_ctr;  // temporary to hold volatile
@@ -325,11 +536,30 @@ void QTimeEvt::armX(QTimeEvtCtr const nTicks, QTimeEvtCtr const interval) {
                  && (nTicks != static_cast<QTimeEvtCtr>(0))
                  && (tickRate < static_cast<uint_fast8_t>(QF_MAX_TICK_RATE))
                  && (static_cast<enum_t>(sig) >= Q_USER_SIG));
+#ifdef QF_TIMEEVT_WHEEL
+    // Gallium - added
+    /// @pre the slack must be less than the interval of a periodic time
+    /// event and must not overflow the expiry
+    Q_REQUIRE_ID(410, ((interval == static_cast<QTimeEvtCtr>(0))
+                       || (slack < interval))
+                 && (static_cast<QTimeEvtCtr>(nTicks + slack) >= nTicks)
+                 && (static_cast<QTimeEvtCtr>(interval + slack)
+                     >= interval));
+#endif // QF_TIMEEVT_WHEEL
 
     QF_CRIT_ENTRY_();
     m_ctr = nTicks;
     m_interval = interval;
 
+#ifdef QF_TIMEEVT_WHEEL
+    // Gallium - added
+    m_slack = slack;
+
+    // a disarmed time event is never linked into the timing wheel
+    linkSlack_(nTicks);
+#else
+    (void)slack; // unused without the timing wheel
+
     // is the time event unlinked?
     // NOTE: For the duration of a single clock tick of the specified tick
     // rate a time event can be disarmed and yet still linked into the list,
@@ -349,6 +579,7 @@ void QTimeEvt::armX(QTimeEvtCtr const nTicks, QTimeEvtCtr const interval) {
         m_next = QF::timeEvtHead_[tickRate].toTimeEvt();
         QF::timeEvtHead_[tickRate].m_act = this;
     }
+#endif // QF_TIMEEVT_WHEEL
 
     QS_BEGIN_NOCRIT_(QS_QF_TIMEEVT_ARM, QS::priv_.teObjFilter, this)
         QS_TIME_();        // timestamp
@@ -395,6 +626,10 @@ bool QTimeEvt::disarm(void) {
             QS_U8_(static_cast<uint8_t>(refCtr_ & static_cast<uint8_t>(0x7F)));
         QS_END_NOCRIT_()
 
+#ifdef QF_TIMEEVT_WHEEL
+        // Gallium - added
+        unlink_();
+#endif // QF_TIMEEVT_WHEEL
         m_ctr = static_cast<QTimeEvtCtr>(0); // schedule removal from the list
     }
     // the time event was already not running
@@ -446,10 +681,24 @@ bool QTimeEvt::rearm(QTimeEvtCtr const nTicks) {
                  && (tickRate < static_cast<uint_fast8_t>(QF_MAX_TICK_RATE))
                  && (nTicks != static_cast<QTimeEvtCtr>(0))
                  && (static_cast<enum_t>(sig) >= Q_USER_SIG));
+#ifdef QF_TIMEEVT_WHEEL
+    // Gallium - added
+    /// @pre the slack given to armX() must not overflow the expiry
+    Q_REQUIRE_ID(610, static_cast<QTimeEvtCtr>(nTicks + m_slack) >= nTicks);
+#endif // QF_TIMEEVT_WHEEL
 
     QF_CRIT_ENTRY_();
     bool isArmed;
 
+#ifdef QF_TIMEEVT_WHEEL
+    // Gallium - added
+    // move the time event to the slot of its new expiry tick
+    isArmed = (m_ctr != static_cast<QTimeEvtCtr>(0));
+    if (isArmed) {
+        unlink_();
+    }
+    linkSlack_(nTicks); // with the slack given to armX()
+#else
     // is the time evt not running? */
     if (m_ctr == static_cast<QTimeEvtCtr>(0)) {
         isArmed = false;
@@ -481,6 +730,7 @@ bool QTimeEvt::rearm(QTimeEvtCtr const nTicks) {
     else {
         isArmed = true;
     }
+#endif // QF_TIMEEVT_WHEEL
     m_ctr = nTicks; // re-load the tick counter (shift the phasing)
 
     QS_BEGIN_NOCRIT_(QS_QF_TIMEEVT_REARM, QS::priv_.teObjFilter, this)
@@ -516,7 +766,16 @@ QTimeEvtCtr QTimeEvt::ctr(void) const {
     QF_CRIT_STAT_
 
     QF_CRIT_ENTRY_();
+#ifdef QF_TIMEEVT_WHEEL
+    // Gallium - added
+    QTimeEvtCtr ret = m_ctr;
+    if (ret != static_cast<QTimeEvtCtr>(0)) {
+        ret = static_cast<QTimeEvtCtr>(m_expiry - QF::timeWheel_[
+                  refCtr_ & static_cast<uint8_t>(0x7F)].m_now);
+    }
+#else
     QTimeEvtCtr ret = m_ctr;
+#endif // QF_TIMEEVT_WHEEL
 
     QS_BEGIN_NOCRIT_(QS_QF_TIMEEVT_CTR, QS::priv_.teObjFilter, this)
         QS_TIME_();            // timestamp
@@ -54,9 +54,34 @@
 
 Q_DEFINE_THIS_MODULE("qxk")
 
+// Gallium - added
+// An AO is ready to run as long as any of its event queues is not empty.
+#if (defined QF_ACTIVE_CTRL_QUEUE) || (defined QF_ISR_POST_LOCKFREE)
+    #define QXK_AO_EMPTY_(a_)   ((a_)->isQueueEmpty_())
+#else
+    #define QXK_AO_EMPTY_(a_)   ((a_)->m_eQueue.isEmpty())
+#endif
+
+// Gallium - added
+// CPU load accounting callbacks (see QP::QXK::onContextSw()).
+#ifdef QXK_CPU_LOAD
+    #define QXK_CONTEXT_SW_(prio_, cause_) \
+        (QP::QXK::onContextSw((prio_), (cause_)))
+    #define QXK_RTC_BEGIN_(prio_, e_)   (QP::QXK::onRtcBegin((prio_), (e_)))
+    #define QXK_RTC_END_(prio_)         (QP::QXK::onRtcEnd(prio_))
+#else
+    #define QXK_CONTEXT_SW_(prio_, cause_) ((void)0)
+    #define QXK_RTC_BEGIN_(prio_, e_)   ((void)0)
+    #define QXK_RTC_END_(prio_)         ((void)0)
+#endif
+
 // Public-scope objects ******************************************************
 extern "C" {
     QXK_Attr QXK_attr_;   // global attributes of the QXK kernel
+#ifdef QXK_CPU_LOAD
+    uint_fast8_t QXK_swCause_; // Gallium - added
+    bool QXK_swUnlock_;        // Gallium - added
+#endif
 } // extern "C"
 
 namespace QP {
@@ -82,11 +107,29 @@ static QXKIdleThread l_idleThread;
 ///
 void QF::init(void) {
     QF_maxPool_      = static_cast<uint_fast8_t>(0);
+#ifdef QF_SUBSCR_COMPACT
+    // Gallium - added
+    QF_subscrSto_    = static_cast<QSubscr *>(0);
+    QF_subscr_       = static_cast<QSubscr const *>(0);
+    QF_nSubscr_      = static_cast<uint_fast16_t>(0);
+    QF_subscrGen_    = static_cast<uint_fast16_t>(0);
+#else
     QF_subscrList_   = static_cast<QSubscrList *>(0);
+#endif // QF_SUBSCR_COMPACT
     QF_maxPubSignal_ = static_cast<enum_t>(0);
 
+#ifdef QF_TIMEEVT_WHEEL
+    // Gallium - added
+    bzero(&timeWheel_[0],   static_cast<uint_fast16_t>(sizeof(timeWheel_)));
+#else
     bzero(&timeEvtHead_[0], static_cast<uint_fast16_t>(sizeof(timeEvtHead_)));
+#endif
     bzero(&active_[0],      static_cast<uint_fast16_t>(sizeof(active_)));
+#ifdef QF_COALESCE_MAX_SIG
+    // Gallium - added
+    bzero(&QF_coalesceSig_[0],
+          static_cast<uint_fast16_t>(sizeof(QF_coalesceSig_)));
+#endif
     bzero(&QXK_attr_,       static_cast<uint_fast16_t>(sizeof(QXK_attr_)));
     bzero(&l_idleThread,    static_cast<uint_fast16_t>(sizeof(l_idleThread)));
 
@@ -253,6 +296,32 @@ extern "C" {
 /// returns with interrupts **disabled**.
 ///
 uint_fast8_t QXK_sched_(void) {
+#ifdef QXK_CPU_LOAD
+    // Gallium - added
+    // Classify the decision for the context switch callback. The current
+    // thread is no longer ready if it has just blocked or terminated, or if
+    // it has lent its slot to the holder of a QXPiMutex.
+    uint_fast8_t cur = (QXK_attr_.curr != static_cast<void *>(0))
+        ? static_cast<QP::QActive volatile *>(QXK_attr_.curr)->m_prio
+        : QXK_attr_.actPrio;
+    if (QXK_ISR_CONTEXT_()) {
+        QXK_swCause_ = QP::QXK::SW_ISR;
+    }
+    else if (QXK_swUnlock_) {
+        QXK_swCause_ = QP::QXK::SW_UNLOCK;
+    }
+    else if ((cur != static_cast<uint_fast8_t>(0))
+             && ((!QXK_attr_.readySet.hasElement(cur))
+                 || (QP::QF::active_[cur] != QXK_attr_.curr)))
+    {
+        QXK_swCause_ = QP::QXK::SW_BLOCK;
+    }
+    else {
+        QXK_swCause_ = QP::QXK::SW_POST;
+    }
+    QXK_swUnlock_ = false;
+#endif // QXK_CPU_LOAD
+
     // find the highest-prio thread ready to run
     uint_fast8_t p = QXK_attr_.readySet.findMax();
 
@@ -289,14 +358,17 @@ uint_fast8_t QXK_sched_(void) {
             QS_END_NOCRIT_()
 
             QXK_attr_.next = next;
+            QXK_CONTEXT_SW_(p, QXK_swCause_); // Gallium - added
             p = static_cast<uint_fast8_t>(0); // no activation needed
             QXK_CONTEXT_SWITCH_();
         }
     }
     else { // currently executing an extended-thread
 
-        // is the new prio different from the current prio?
-        if (p != static_cast<QP::QActive volatile*>(QXK_attr_.curr)->m_prio) {
+        // is the next thread different from the current one?
+        // Gallium - compare threads, since the holder of a QXPiMutex runs
+        // in the priority slot of the thread blocked on it
+        if (next != QXK_attr_.curr) {
             QS_BEGIN_NOCRIT_(QP::QS_SCHED_NEXT, QP::QS::priv_.aoObjFilter,
                              QXK_attr_.next)
                 QS_TIME_();         // timestamp
@@ -306,6 +378,7 @@ uint_fast8_t QXK_sched_(void) {
             QS_END_NOCRIT_()
 
             QXK_attr_.next = next;
+            QXK_CONTEXT_SW_(p, QXK_swCause_); // Gallium - added
             p = static_cast<uint_fast8_t>(0); // no activation needed
             QXK_CONTEXT_SWITCH_();
         }
@@ -337,12 +410,23 @@ void QXK_activate_(void) {
     uint_fast8_t pprev = pin;
 #endif // Q_SPY
 
+#ifdef QXK_CPU_LOAD
+    // Gallium - added
+    // The first AO is activated for the reason found by QXK_sched_(), the
+    // following ones because the previous RTC step has completed.
+    uint_fast8_t cause = QXK_swCause_;
+#endif
+
     // loop until no more ready-to-run AOs of higher prio than the initial
     do  {
         a = QP::QF::active_[p]; // obtain the pointer to the AO
 
         QXK_attr_.actPrio = p; // this becomes the active prio
         QXK_attr_.next = static_cast<void *>(0); // clear the next AO
+        QXK_CONTEXT_SW_(p, cause); // Gallium - added
+#ifdef QXK_CPU_LOAD
+        cause = QP::QXK::SW_NEXT;
+#endif
 
         QS_BEGIN_NOCRIT_(QP::QS_SCHED_NEXT, QP::QS::priv_.aoObjFilter, a)
             QS_TIME_();         // timestamp
@@ -365,12 +449,41 @@ void QXK_activate_(void) {
         // 3. determine if event is garbage and collect it if so
         //
         QP::QEvt const *e = a->get_();
+#ifdef QF_EVT_LATENCY
+        QP::QF::onEvtDispatch(p, e); // Gallium - added
+#endif
+        QXK_RTC_BEGIN_(p, e); // Gallium - added
         a->dispatch(e);
+        QXK_RTC_END_(p);   // Gallium - added
         QP::QF::gc(e);
 
+        // Gallium - added
+        // Burst mode. Dispatch more queued events of the same AO without
+        // going through the scheduling step below, as long as no thread of
+        // higher priority has become ready.
+        for (uint_fast8_t n = a->getBurst(); n > static_cast<uint_fast8_t>(1);
+             --n)
+        {
+            QF_INT_DISABLE();
+            bool more = (!QXK_AO_EMPTY_(a))
+                        && (QXK_attr_.readySet.findMax() <= p);
+            QF_INT_ENABLE();
+            if (!more) {
+                break;
+            }
+            e = a->get_();
+#ifdef QF_EVT_LATENCY
+            QP::QF::onEvtDispatch(p, e);
+#endif
+            QXK_RTC_BEGIN_(p, e);
+            a->dispatch(e);
+            QXK_RTC_END_(p);
+            QP::QF::gc(e);
+        }
+
         QF_INT_DISABLE(); // unconditionally disable interrupts
 
-        if (a->m_eQueue.isEmpty()) { // empty queue?
+        if (QXK_AO_EMPTY_(a)) { // empty queue(s)?
             QXK_attr_.readySet.remove(p);
         }
 
@@ -406,6 +519,7 @@ void QXK_activate_(void) {
             QS_END_NOCRIT_()
 
             QXK_attr_.next = a;
+            QXK_CONTEXT_SW_(p, QP::QXK::SW_NEXT); // Gallium - added
             p = static_cast<uint_fast8_t>(0); // no activation needed
             QXK_CONTEXT_SWITCH_();
         }
@@ -413,6 +527,12 @@ void QXK_activate_(void) {
 
     QXK_attr_.actPrio = pin; // restore the active priority (!)
 
+    // Gallium - added
+    // Back to the preempted thread, unless switching to an extended thread.
+    if (QXK_attr_.next == static_cast<void *>(0)) {
+        QXK_CONTEXT_SW_(pin, QP::QXK::SW_RESUME);
+    }
+
 #ifdef Q_SPY
     if (pin != static_cast<uint_fast8_t>(0)) { // resuming an active object?
         a = QP::QF::active_[pin]; // the pointer to the preempted AO
@@ -0,0 +1,254 @@
+/// @file
+/// @brief QXK/C++ preemptive kernel message queue implementation
+/// @ingroup qxk
+/// @cond
+////**************************************************************************
+/// Gallium - added
+///
+/// Copyright (C) 2017 Gallium Studio LLC (Lawrence Lo). All rights reserved.
+///
+/// This program is open source software: you can redistribute it and/or
+/// modify it under the terms of the GNU General Public License as published
+/// by the Free Software Foundation, either version 3 of the License, or
+/// (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program. If not, see <http://www.gnu.org/licenses/>.
+////**************************************************************************
+/// @endcond
+
+#define QP_IMPL           // this is QP implementation
+#include "qf_port.h"      // QF port
+#include "qxk_pkg.h"      // QXK package-scope internal interface
+#include "qassert.h"      // QP embedded systems-friendly assertions
+#ifdef Q_SPY              // QS software tracing enabled?
+    #include "qs_port.h"  // include QS port
+#else
+    #include "qs_dummy.h" // disable the QS software tracing
+#endif // Q_SPY
+
+// protection against including this source file in a wrong project
+#ifndef qxk_h
+    #error "Source file included in a project NOT based on the QXK kernel"
+#endif // qxk_h
+
+namespace QP {
+
+Q_DEFINE_THIS_MODULE("qxk_msgq")
+
+//****************************************************************************
+// copy a message, called from within a critical section
+static void msgCopy_(uint8_t *dst, uint8_t const *src, uint_fast16_t n) {
+    for (; n != static_cast<uint_fast16_t>(0); --n) {
+        *dst = *src;
+        ++dst;
+        ++src;
+    }
+}
+
+//****************************************************************************
+/// @description
+/// Initializes a message queue with the storage for @p qLen messages of
+/// @p msgSize bytes each.
+///
+/// @param[in]     qSto    pointer to the storage of qLen * msgSize bytes
+/// @param[in]     msgSize size of a message [in bytes]
+/// @param[in]     qLen    length of the queue [in messages]
+///
+/// @note
+/// QXMsgQueue::init() must be called **before** the queue can be used.
+///
+void QXMsgQueue::init(void * const qSto, uint_fast16_t const msgSize,
+                      uint_fast16_t const qLen)
+{
+    Q_REQUIRE_ID(100, (qSto != static_cast<void *>(0))
+        && (msgSize != static_cast<uint_fast16_t>(0))
+        && (qLen != static_cast<uint_fast16_t>(0)));
+
+    m_ring    = static_cast<uint8_t *>(qSto);
+    m_msgSize = msgSize;
+    m_end     = qLen;
+    m_head    = static_cast<uint_fast16_t>(0);
+    m_tail    = static_cast<uint_fast16_t>(0);
+    m_nFree   = qLen;
+    m_nMin    = qLen;
+    m_getSet.setEmpty();
+    m_putSet.setEmpty();
+}
+
+//****************************************************************************
+/// @description
+/// Copies the message into the queue. When the queue is full, an extended
+/// thread blocks until a slot is freed by QXMsgQueue::get() or the timeout
+/// expires, while an ISR or a basic thread (AO) returns right away.
+///
+/// @param[in]  msg       pointer to the message to copy (msgSize bytes)
+/// @param[in]  nTicks    number of clock ticks (at the associated rate)
+///                       to wait for a free slot. The value of
+///                       QXTHREAD_NO_TIMEOUT indicates that no timeout will
+///                       occur. Ignored outside extended threads.
+/// @param[in]  tickRate  system clock tick rate serviced in this call.
+///
+/// @returns
+/// true if the message has been put, and false if the queue was full.
+///
+bool QXMsgQueue::put(void const * const msg, uint_fast16_t const nTicks,
+                     uint_fast8_t const tickRate)
+{
+    QF_CRIT_STAT_
+    QF_CRIT_ENTRY_();
+
+    QXThread *thr = static_cast<QXThread *>(QXK_attr_.curr);
+
+    Q_REQUIRE_ID(200, (msg != static_cast<void const *>(0))
+        && (m_ring != static_cast<uint8_t *>(0)));
+
+    // only an extended thread can block
+    bool timedOut = (QXK_ISR_CONTEXT_()
+                     || (thr == static_cast<QXThread *>(0)));
+    while ((m_nFree == static_cast<uint_fast16_t>(0)) && (!timedOut)) {
+        // the thread must not be blocked on any object
+        Q_ASSERT_ID(210, thr->m_temp.obj == static_cast<QMState const *>(0));
+
+        // remember the blocking object
+        thr->m_temp.obj = reinterpret_cast<QMState const *>(this);
+        thr->teArm_(static_cast<enum_t>(QXK_MSGQ_SIG), nTicks, tickRate);
+        m_putSet.insert(thr->m_prio);
+        thr->block_();
+        QF_CRIT_EXIT_();
+        QF_CRIT_EXIT_NOP(); // BLOCK here
+
+        QF_CRIT_ENTRY_();
+        // the blocking object must be this queue
+        Q_ASSERT_ID(220, thr->m_temp.obj
+                         == reinterpret_cast<QMState const *>(this));
+        thr->m_temp.obj = static_cast<QMState const *>(0); // clear
+        m_putSet.remove(thr->m_prio); // still there after the timeout
+        // signal of zero means that the time event has expired
+        timedOut = (thr->m_timeEvt.sig == static_cast<QSignal>(0));
+    }
+
+    bool status;
+    if (m_nFree != static_cast<uint_fast16_t>(0)) {
+        msgCopy_(&m_ring[m_head * m_msgSize],
+                 static_cast<uint8_t const *>(msg), m_msgSize);
+        ++m_head;
+        if (m_head == m_end) {
+            m_head = static_cast<uint_fast16_t>(0); // wrap around
+        }
+        --m_nFree;
+        if (m_nMin > m_nFree) {
+            m_nMin = m_nFree; // update minimum so far
+        }
+        wake_(&m_getSet);
+        status = true;
+    }
+    else {
+        status = false;
+    }
+    QF_CRIT_EXIT_();
+
+    return status;
+}
+
+//****************************************************************************
+/// @description
+/// Copies the message at the front of the queue out and frees its slot.
+/// When the queue is empty, the calling extended thread blocks until a
+/// message is put or the timeout expires.
+///
+/// @param[out] msg       pointer to the buffer of msgSize bytes
+/// @param[in]  nTicks    number of clock ticks (at the associated rate)
+///                       to wait for a message. The value of
+///                       QXTHREAD_NO_TIMEOUT indicates that no timeout will
+///                       occur.
+/// @param[in]  tickRate  system clock tick rate serviced in this call.
+///
+/// @returns
+/// true if a message has been copied, and false if the timeout occured.
+///
+bool QXMsgQueue::get(void * const msg, uint_fast16_t const nTicks,
+                     uint_fast8_t const tickRate)
+{
+    QF_CRIT_STAT_
+    QF_CRIT_ENTRY_();
+
+    QXThread *thr = static_cast<QXThread *>(QXK_attr_.curr);
+
+    Q_REQUIRE_ID(300, (!QXK_ISR_CONTEXT_()) /* can't block inside an ISR */
+        && (thr != static_cast<QXThread *>(0)) /* current must be extended */
+        && (thr->m_temp.obj == static_cast<QMState const *>(0)) /* !blocked */
+        && (msg != static_cast<void *>(0))
+        && (m_ring != static_cast<uint8_t *>(0)));
+
+    bool timedOut = false;
+    while ((m_nFree == m_end) && (!timedOut)) {
+        // remember the blocking object
+        thr->m_temp.obj = reinterpret_cast<QMState const *>(this);
+        thr->teArm_(static_cast<enum_t>(QXK_MSGQ_SIG), nTicks, tickRate);
+        m_getSet.insert(thr->m_prio);
+        thr->block_();
+        QF_CRIT_EXIT_();
+        QF_CRIT_EXIT_NOP(); // BLOCK here
+
+        QF_CRIT_ENTRY_();
+        // the blocking object must be this queue
+        Q_ASSERT_ID(310, thr->m_temp.obj
+                         == reinterpret_cast<QMState const *>(this));
+        thr->m_temp.obj = static_cast<QMState const *>(0); // clear
+        m_getSet.remove(thr->m_prio); // still there after the timeout
+        // signal of zero means that the time event has expired
+        timedOut = (thr->m_timeEvt.sig == static_cast<QSignal>(0));
+    }
+
+    bool status;
+    if (m_nFree != m_end) {
+        msgCopy_(static_cast<uint8_t *>(msg),
+                 &m_ring[m_tail * m_msgSize], m_msgSize);
+        ++m_tail;
+        if (m_tail == m_end) {
+            m_tail = static_cast<uint_fast16_t>(0); // wrap around
+        }
+        ++m_nFree;
+        wake_(&m_putSet);
+        status = true;
+    }
+    else {
+        status = false;
+    }
+    QF_CRIT_EXIT_();
+
+    return status;
+}
+
+//****************************************************************************
+/// @description
+/// Makes the highest-priority extended thread waiting in @p waitSet ready
+/// to run. The woken thread re-checks the queue when it runs.
+///
+/// @note
+/// must be called from within a critical section
+///
+void QXMsgQueue::wake_(QPSet * const waitSet) {
+    if (waitSet->notEmpty()) {
+        uint_fast8_t p = waitSet->findMax();
+        waitSet->remove(p);
+
+        QXThread *thr = static_cast<QXThread *>(QF::active_[p]);
+
+        // the thread must be extended and blocked on this queue
+        Q_ASSERT_ID(410, (thr->m_thread != static_cast<void *>(0))
+            && (thr->m_temp.obj == reinterpret_cast<QMState const *>(this)));
+
+        // disarm the internal time event
+        (void)thr->teDisarm_();
+        thr->unblock_();
+    }
+}
+
+} // namespace QP
@@ -170,6 +170,9 @@ void QXMutex::unlock(void) {
 
     if (QXK_attr_.lockPrio > p) {
         QXK_attr_.lockPrio = p; // restore the previous lock prio
+#ifdef QXK_CPU_LOAD
+        QXK_swUnlock_ = true; // Gallium - added
+#endif
         // find the highest-prio thread ready to run
         if (QXK_sched_() != static_cast<uint_fast8_t>(0)) { // priority found?
             QXK_activate_(); // activate any unlocked basic threads
@@ -178,4 +181,161 @@ void QXMutex::unlock(void) {
     QF_CRIT_EXIT_();
 }
 
+//****************************************************************************
+// Gallium - added
+/// @description
+/// Initializes the QXK priority-inheritance mutex as free.
+///
+/// @note
+/// A mutex must be initialized before it can be locked or unlocked.
+///
+void QXPiMutex::init(void) {
+    m_holder = static_cast<QXThread *>(0);
+    m_lender = static_cast<QActive *>(0);
+    m_holderPrio = static_cast<uint_fast8_t>(0);
+    m_waitSet.setEmpty();
+}
+
+//****************************************************************************
+// Gallium - added
+/// @description
+/// Locks the QXK priority-inheritance mutex. If it is held by another
+/// thread, the calling extended thread blocks until the mutex is handed over
+/// to it by QP::QXPiMutex::unlock(). Meanwhile the holder runs at the
+/// priority of the calling thread if that is higher, so the blocking time
+/// is bounded by the time the holder keeps the mutex.
+///
+/// @sa QP::QXPiMutex::init(), QP::QXPiMutex::unlock()
+///
+void QXPiMutex::lock(void) {
+    QF_CRIT_STAT_
+    QF_CRIT_ENTRY_();
+
+    QXThread *thr = static_cast<QXThread *>(QXK_attr_.curr);
+
+    /// @pre must be called from an extended thread, which is not blocked
+    /// and does not hold the mutex already
+    Q_REQUIRE_ID(900, (!QXK_ISR_CONTEXT_())
+        && (thr != static_cast<QXThread *>(0))
+        && (thr->m_temp.obj == static_cast<QMState const *>(0))
+        && (thr != m_holder));
+
+    if (m_holder == static_cast<QXThread *>(0)) { // mutex free?
+        m_holder = thr;
+        m_holderPrio = thr->m_prio;
+    }
+    else {
+        // the holder must be ready to run, as it cannot block
+        Q_ASSERT_ID(910, QXK_attr_.readySet.hasElement(m_holder->m_prio));
+
+        // remember the blocking object
+        thr->m_temp.obj = reinterpret_cast<QMState const *>(this);
+        m_waitSet.insert(thr->m_prio);
+        QXK_attr_.readySet.remove(thr->m_prio);
+
+        // the holder inherits the priority of the highest waiter
+        uint_fast8_t p = m_waitSet.findMax();
+        if (p > m_holder->m_prio) {
+            boost_();
+        }
+        (void)QXK_sched_();
+        QF_CRIT_EXIT_();
+        QF_CRIT_EXIT_NOP(); // BLOCK here
+
+        QF_CRIT_ENTRY_();
+        // the mutex must have been handed over to this thread
+        Q_ASSERT_ID(920, (m_holder == thr)
+            && (thr->m_temp.obj == reinterpret_cast<QMState const *>(this)));
+        thr->m_temp.obj = static_cast<QMState const *>(0); // clear
+    }
+    QF_CRIT_EXIT_();
+}
+
+//****************************************************************************
+// Gallium - added
+/// @description
+/// Unlocks the QXK priority-inheritance mutex. The holder returns to its own
+/// priority and the mutex is handed over to the highest-priority waiter,
+/// which becomes ready to run.
+///
+/// @sa QP::QXPiMutex::init(), QP::QXPiMutex::lock()
+///
+void QXPiMutex::unlock(void) {
+    QF_CRIT_STAT_
+    QF_CRIT_ENTRY_();
+
+    QXThread *thr = static_cast<QXThread *>(QXK_attr_.curr);
+
+    /// @pre must be called from the extended thread holding the mutex
+    Q_REQUIRE_ID(950, (!QXK_ISR_CONTEXT_())
+        && (thr != static_cast<QXThread *>(0))
+        && (thr == m_holder));
+
+    if (m_lender != static_cast<QActive *>(0)) { // running boosted?
+        unboost_();
+    }
+
+    if (m_waitSet.notEmpty()) {
+        uint_fast8_t p = m_waitSet.findMax();
+        m_waitSet.remove(p);
+        m_holder = static_cast<QXThread *>(QF::active_[p]);
+        m_holderPrio = p;
+
+        // the new holder must be blocked on this mutex
+        Q_ASSERT_ID(960, m_holder->m_temp.obj
+                         == reinterpret_cast<QMState const *>(this));
+
+        // the remaining waiters have lower priorities, so no boost
+        QXK_attr_.readySet.insert(p);
+    }
+    else {
+        m_holder = static_cast<QXThread *>(0);
+    }
+
+#ifdef QXK_CPU_LOAD
+    QXK_swUnlock_ = true;
+#endif
+    (void)QXK_sched_();
+    QF_CRIT_EXIT_();
+}
+
+//****************************************************************************
+// Gallium - added
+/// @description
+/// Moves the holder to the priority slot of the highest waiter, giving back
+/// the slot it has borrowed before (if any).
+///
+/// @note
+/// must be called from within a critical section
+///
+void QXPiMutex::boost_(void) {
+    if (m_lender != static_cast<QActive *>(0)) {
+        unboost_();
+    }
+    uint_fast8_t p = m_waitSet.findMax();
+    QXK_attr_.readySet.remove(m_holderPrio);
+    m_lender = QF::active_[p];
+    QF::active_[p] = m_holder;
+    m_holder->m_prio = p;
+    QXK_attr_.readySet.insert(p);
+}
+
+//****************************************************************************
+// Gallium - added
+/// @description
+/// Moves the holder back to its own priority slot and gives the borrowed
+/// slot back to its blocked owner.
+///
+/// @note
+/// must be called from within a critical section
+///
+void QXPiMutex::unboost_(void) {
+    uint_fast8_t p = m_holder->m_prio;
+    QXK_attr_.readySet.remove(p);
+    QF::active_[p] = m_lender;
+    m_lender = static_cast<QActive *>(0);
+    m_holder->m_prio = m_holderPrio;
+    QXK_attr_.readySet.insert(m_holderPrio);
+}
+
 } // namespace QP
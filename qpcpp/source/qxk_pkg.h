@@ -45,7 +45,8 @@ namespace QP {
 enum QXK_Timeouts {
     QXK_DELAY_SIG = Q_USER_SIG,
     QXK_QUEUE_SIG,
-    QXK_SEMA_SIG
+    QXK_SEMA_SIG,
+    QXK_MSGQ_SIG  // Gallium - added
 };
 
 } // namespace QP
@@ -60,6 +61,15 @@ void QXK_stackInit_(void *act, QP::QXThreadHandler handler,
 //! called when a thread function returns
 void QXK_threadRet_(void);
 
+#ifdef QXK_CPU_LOAD
+// Gallium - added
+//! cause of the last scheduling decision of QXK_sched_()
+extern uint_fast8_t QXK_swCause_;
+
+//! set by QXMutex::unlock() around QXK_sched_()
+extern bool QXK_swUnlock_;
+#endif // QXK_CPU_LOAD
+
 } // extern "C"
 
 #include "qf_pkg.h"  // QF package-scope interface
@@ -74,7 +74,9 @@ Q_DEFINE_THIS_MODULE("qxk_xthr")
 QXThread::QXThread(QXThreadHandler const handler, uint_fast8_t const tickRate)
   : QActive(Q_STATE_CAST(handler)),
     m_timeEvt(this, static_cast<enum_t>(QXK_DELAY_SIG),
-                    static_cast<uint8_t>(tickRate))
+                    static_cast<uint8_t>(tickRate)),
+    m_stkSto(static_cast<void *>(0)),        // Gallium - added
+    m_stkSize(static_cast<uint_fast16_t>(0)) // Gallium - added
 {
     m_state.act = Q_ACTION_CAST(0); // mark as extended thread
 }
@@ -135,6 +137,8 @@ void QXThread::start(uint_fast8_t const prio,
     // the top-most initial transition 'm_temp.act'
     QXK_stackInit_(this, reinterpret_cast<QXThreadHandler>(m_temp.act),
                    stkSto, stkSize);
+    m_stkSto = stkSto;   // Gallium - added
+    m_stkSize = stkSize; // Gallium - added
 
     m_prio = prio;
 
@@ -227,6 +231,7 @@ bool QXThread::post_(QEvt const * const e, uint_fast16_t const margin,
 
             --nFree;  // one free entry just used up
             m_eQueue.m_nFree = nFree;     // update the volatile
+            QF_EQUEUE_POST_INC_(m_eQueue); // Gallium - added
             if (m_eQueue.m_nMin > nFree) {
                 m_eQueue.m_nMin = nFree;  // update minimum so far
             }
@@ -265,6 +270,7 @@ bool QXThread::post_(QEvt const * const e, uint_fast16_t const margin,
             /// @note assert if event cannot be posted and dropping events is
             /// not acceptable
             Q_ASSERT_ID(310, margin != static_cast<uint_fast16_t>(0));
+            QF_EQUEUE_REJECT_INC_(m_eQueue); // Gallium - added
 
             QS_BEGIN_NOCRIT_(QS_QF_ACTIVE_POST_ATTEMPT, QS::priv_.aoObjFilter,
                              this)
@@ -304,6 +310,31 @@ void QXThread::postLIFO(QEvt const * const /*e*/) {
     Q_ERROR_ID(410);
 }
 
+//****************************************************************************
+// Gallium - added
+/// @description
+/// QXK_stackInit_() fills the private stack with 0xDEADBEEF, from the first
+/// 8-byte aligned word up to the initial stack frame. The stack grows down,
+/// so the used part ends at the lowest word no longer holding the pattern.
+///
+/// @note Must be called after the thread has been started.
+///
+uint_fast16_t QXThread::getStackUsed(void) const {
+    Q_REQUIRE_ID(420, m_stkSto != static_cast<void *>(0));
+
+    uint8_t const *base = static_cast<uint8_t const *>(m_stkSto);
+    uint8_t const *top = base + m_stkSize;
+    uint32_t const *p = reinterpret_cast<uint32_t const *>(
+        base + ((8U - (reinterpret_cast<uintptr_t>(base) & 7U)) & 7U));
+    while ((reinterpret_cast<uint8_t const *>(p) < top)
+           && (*p == static_cast<uint32_t>(0xDEADBEEFU)))
+    {
+        ++p;
+    }
+    return static_cast<uint_fast16_t>(
+        top - reinterpret_cast<uint8_t const *>(p));
+}
+
 //****************************************************************************
 /// @description
 /// The QXThread_queueGet() operation allows the calling extended thread to
@@ -462,6 +493,12 @@ void QXThread::teArm_(enum_t const sig,
         m_timeEvt.m_ctr = static_cast<QTimeEvtCtr>(nTicks);
         m_timeEvt.m_interval = static_cast<QTimeEvtCtr>(0);
 
+#ifdef QF_TIMEEVT_WHEEL
+        // Gallium - added
+        // the time event is unlinked, so it can take the requested tick rate
+        m_timeEvt.refCtr_ = static_cast<uint8_t>(tickRate);
+        m_timeEvt.link_(static_cast<QTimeEvtCtr>(nTicks));
+#else
         // is the time event unlinked?
         // NOTE: For the duration of a single clock tick of the specified tick
         // rate a time event can be disarmed and yet still linked in the list,
@@ -482,6 +519,7 @@ void QXThread::teArm_(enum_t const sig,
                 static_cast<QTimeEvt *>(QF::timeEvtHead_[tickRate].m_act);
             QF::timeEvtHead_[tickRate].m_act = &m_timeEvt;
         }
+#endif // QF_TIMEEVT_WHEEL
     }
 }
 
@@ -497,6 +535,10 @@ bool QXThread::teDisarm_(void) {
     // is the time evt running?
     if (m_timeEvt.m_ctr != static_cast<QTimeEvtCtr>(0)) {
         wasArmed = true;
+#ifdef QF_TIMEEVT_WHEEL
+        // Gallium - added
+        m_timeEvt.unlink_();
+#endif // QF_TIMEEVT_WHEEL
         // schedule removal from list
         m_timeEvt.m_ctr = static_cast<QTimeEvtCtr>(0);
     }